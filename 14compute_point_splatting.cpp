@@ -0,0 +1,388 @@
+/* OpenGL example code - Compute Shader Point Splatting
+ *
+ * Renders the galaxy from the geometry shader example with many more
+ * particles. Instead of blending a billboard per particle each point is
+ * projected in a compute shader and its intensity is added to a screen
+ * sized accumulation buffer with atomicAdd. A full screen resolve pass
+ * then blurs and tonemaps the accumulated values. The cost scales with
+ * the number of points instead of the overdraw.
+ *
+ * toggle the blur in the resolve pass with space
+ *
+ * This example requires at least OpenGL 4.3
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// uniformly distributed random number in [0,1]
+float frand() {
+    return std::rand()/float(RAND_MAX);
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "14compute_point_splatting", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // the splat shader projects each point and atomically adds its
+    // intensity as a fixed point value to the pixel it lands on.
+    // every invocation walks over the points with a stride of the
+    // total invocation count so the dispatch size doesn't depend on
+    // the number of points.
+    std::string splat_source =
+        "#version 430\n"
+        "layout(local_size_x=256) in;\n"
+
+        "layout(location = 0) uniform mat4 ViewProjection;\n"
+        "layout(location = 1) uniform ivec2 size;\n"
+        "layout(location = 2) uniform uint count;\n"
+        "layout(std430, binding=0) readonly buffer pblock { float positions[]; };\n"
+        "layout(std430, binding=1) buffer ablock { uint accumulation[]; };\n"
+
+        "void main() {\n"
+        "   uint stride = gl_NumWorkGroups.x*gl_WorkGroupSize.x;\n"
+        "   for(uint i = gl_GlobalInvocationID.x;i<count;i+=stride) {\n"
+        "       vec4 pos = vec4(positions[3*i+0], positions[3*i+1], positions[3*i+2], 1);\n"
+        "       vec4 clip = ViewProjection*pos;\n"
+        "       if(clip.w<=0.1) continue;\n"
+        "       vec2 ndc = clip.xy/clip.w;\n"
+        "       ivec2 pixel = ivec2((0.5*ndc+0.5)*vec2(size));\n"
+        "       if(any(lessThan(pixel, ivec2(0))) || any(greaterThanEqual(pixel, size))) continue;\n"
+        // the energy of a world space billboard falls off with 1/w^2
+        "       float intensity = min(1.0, 400.0/(clip.w*clip.w));\n"
+        "       atomicAdd(accumulation[pixel.y*size.x+pixel.x], uint(256.0*intensity));\n"
+        "   }\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint splat_program, splat_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler compute shader
+    splat_shader = glCreateShader(GL_COMPUTE_SHADER);
+    source = splat_source.c_str();
+    length = splat_source.size();
+    glShaderSource(splat_shader, 1, &source, &length);
+    glCompileShader(splat_shader);
+    if(!check_shader_compile_status(splat_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    splat_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(splat_program, splat_shader);
+
+    // link the program and check for errors
+    glLinkProgram(splat_program);
+    check_program_link_status(splat_program);
+
+    // the resolve pass draws a full screen triangle that is generated
+    // from gl_VertexID so it doesn't need any vertex buffers
+    std::string resolve_vertex_source =
+        "#version 430\n"
+        "void main() {\n"
+        "   vec2 pos = vec2(float((gl_VertexID&1)<<2)-1, float((gl_VertexID&2)<<1)-1);\n"
+        "   gl_Position = vec4(pos, 0, 1);\n"
+        "}\n";
+
+    // the fragment shader convolves the accumulation buffer with the same
+    // bell like radial distribution the billboards use and tonemaps
+    // the result
+    std::string resolve_fragment_source =
+        "#version 430\n"
+        "layout(location = 0) uniform ivec2 size;\n"
+        "layout(location = 1) uniform int radius;\n"
+        "layout(std430, binding=1) readonly buffer ablock { uint accumulation[]; };\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   ivec2 center = ivec2(gl_FragCoord.xy);\n"
+        "   float sum = 0, weights = 0;\n"
+        "   for(int y = -radius;y<=radius;++y) {\n"
+        "       for(int x = -radius;x<=radius;++x) {\n"
+        "           ivec2 pixel = clamp(center+ivec2(x,y), ivec2(0), size-1);\n"
+        "           float r2 = float(x*x+y*y)/float((radius+1)*(radius+1));\n"
+        "           float weight = 1/(1+15.*r2)-1/16.;\n"
+        "           sum += weight*float(accumulation[pixel.y*size.x+pixel.x]);\n"
+        "           weights += weight;\n"
+        "       }\n"
+        "   }\n"
+        "   float value = 1-exp(-sum/(64.0*weights));\n"
+        "   FragColor = value*vec4(1,0.9,0.6,1);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint resolve_program, resolve_vertex_shader, resolve_fragment_shader;
+
+    // create and compiler vertex shader
+    resolve_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = resolve_vertex_source.c_str();
+    length = resolve_vertex_source.size();
+    glShaderSource(resolve_vertex_shader, 1, &source, &length);
+    glCompileShader(resolve_vertex_shader);
+    if(!check_shader_compile_status(resolve_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    resolve_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = resolve_fragment_source.c_str();
+    length = resolve_fragment_source.size();
+    glShaderSource(resolve_fragment_shader, 1, &source, &length);
+    glCompileShader(resolve_fragment_shader);
+    if(!check_shader_compile_status(resolve_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    resolve_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(resolve_program, resolve_vertex_shader);
+    glAttachShader(resolve_program, resolve_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(resolve_program);
+    check_program_link_status(resolve_program);
+
+    const int particles = 16*1024*1024;
+
+    // create a galaxylike distribution of points
+    std::cout << "generating particles, this may take a while." << std::endl;
+    std::vector<GLfloat> positionData(particles*3);
+    for(int i = 0;i<particles;++i)
+    {
+        int arm = 3*frand();
+        float alpha = 1/(0.1f+std::pow(frand(),0.7f))-1/1.1f;
+        float r = 4.0f*alpha;
+        alpha += arm*2.0f*3.1416f/3.0f;
+
+        positionData[3*i+0] = r*std::sin(alpha);
+        positionData[3*i+1] = 0;
+        positionData[3*i+2] = r*std::cos(alpha);
+
+        positionData[3*i+0] += (4.0f-0.2*alpha)*(2-(frand()+frand()+frand()+frand()));
+        positionData[3*i+1] += (2.0f-0.1*alpha)*(2-(frand()+frand()+frand()+frand()));
+        positionData[3*i+2] += (4.0f-0.2*alpha)*(2-(frand()+frand()+frand()+frand()));
+    }
+
+    // buffer handles
+    GLuint positions_ssbo, accumulation_ssbo;
+
+    glGenBuffers(1, &positions_ssbo);
+    glGenBuffers(1, &accumulation_ssbo);
+
+    // fill with data
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, positions_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLfloat)*positionData.size(), &positionData[0], GL_STATIC_DRAW);
+
+    // one fixed point counter per pixel
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, accumulation_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint)*width*height, 0, GL_DYNAMIC_COPY);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, positions_ssbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, accumulation_ssbo);
+
+    // the resolve pass doesn't need any attributes but a vao
+    // still has to be bound
+    GLuint vao;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // setup uniforms
+    glUseProgram(splat_program);
+    glUniform2i(1, width, height);
+    glUniform1ui(2, particles);
+
+    glUseProgram(resolve_program);
+    glUniform2i(0, width, height);
+
+    // no depth testing or blending required, the resolve pass
+    // overwrites every pixel
+    glDisable(GL_DEPTH_TEST);
+
+    // timer query setup, one query for each pass
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint splat_queries[querycount], resolve_queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, splat_queries);
+    glGenQueries(querycount, resolve_queries);
+
+    bool blur = true;
+    bool space_down = false;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle blur
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            blur = !blur;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -50.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*std::sin(0.1f*t), glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, -22.5f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        glBeginQuery(GL_TIME_ELAPSED, splat_queries[current_query]);
+
+        // reset the accumulation buffer
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, accumulation_ssbo);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+
+        // splat the points
+        glUseProgram(splat_program);
+        glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glDispatchCompute(1024, 1, 1);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // make the atomic writes visible to the resolve pass
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glBeginQuery(GL_TIME_ELAPSED, resolve_queries[current_query]);
+
+        // resolve to the screen
+        glUseProgram(resolve_program);
+        glUniform1i(1, blur?3:0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(splat_queries[(current_query+1)%querycount])) {
+            GLuint64 splat_result, resolve_result;
+            glGetQueryObjectui64v(splat_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &splat_result);
+            glGetQueryObjectui64v(resolve_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &resolve_result);
+            std::cout << splat_result*1.e-6 << " ms splat " << resolve_result*1.e-6 << " ms resolve" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, splat_queries);
+    glDeleteQueries(querycount, resolve_queries);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &positions_ssbo);
+    glDeleteBuffers(1, &accumulation_ssbo);
+
+    glDetachShader(splat_program, splat_shader);
+    glDeleteShader(splat_shader);
+    glDeleteProgram(splat_program);
+
+    glDetachShader(resolve_program, resolve_vertex_shader);
+    glDetachShader(resolve_program, resolve_fragment_shader);
+    glDeleteShader(resolve_vertex_shader);
+    glDeleteShader(resolve_fragment_shader);
+    glDeleteProgram(resolve_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,549 @@
+/* OpenGL example code - Galaxy Octree LOD
+ *
+ * Renders the galaxy from the geometry shader example with an octree
+ * over the particles. The octree is built once and every node stores
+ * the aggregated luminosity and color of the stars below it. Nodes
+ * that are small on screen are drawn as a single fat splat and only
+ * nearby nodes are expanded into their individual stars. Since the
+ * stars are reordered so that every node covers a contiguous range of
+ * the vertex buffer the expanded nodes are drawn with a single
+ * glMultiDrawArrays call.
+ *
+ * increase/decrease the screen space error threshold with up/down
+ * toggle the level of detail with space
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// a star or an aggregated splat. position.w is the world space size
+// of the billboard and color is premultiplied with the intensity
+struct Splat {
+    glm::vec4 position;
+    glm::vec4 color;
+};
+
+// octree node that covers the stars in [begin, end)
+struct Node {
+    glm::vec3 centroid;
+    float radius;
+    glm::vec4 color;
+    int begin, end;
+    int children[8];
+};
+
+// predicate to partition stars along one axis
+class AxisPred {
+public:
+    AxisPred(int a, float s) : axis(a), split(s) { }
+    bool operator()(const Splat &s) {
+        return s.position[axis] < split;
+    }
+private:
+    const int axis;
+    const float split;
+};
+
+// recursively build the octree for the stars in [begin, end). The stars
+// are partitioned in place so every child covers a subrange of its parent.
+int build_octree(std::vector<Node> &nodes, std::vector<Splat> &stars,
+                 int begin, int end, glm::vec3 center, float halfsize, int depth) {
+    Node node;
+    node.begin = begin;
+    node.end = end;
+
+    // aggregate luminosity and color weighted centroid
+    glm::vec3 centroid(0.0f);
+    glm::vec3 color(0.0f);
+    float luminosity = 0.0f;
+    for(int i = begin;i<end;++i) {
+        float l = stars[i].color.r+stars[i].color.g+stars[i].color.b;
+        centroid += l*glm::vec3(stars[i].position);
+        color += glm::vec3(stars[i].color);
+        luminosity += l;
+    }
+    node.centroid = centroid/luminosity;
+
+    // rms spread around the centroid determines the size of the splat
+    float spread = 0.0f;
+    for(int i = begin;i<end;++i) {
+        glm::vec3 diff = glm::vec3(stars[i].position)-node.centroid;
+        spread += glm::dot(diff, diff);
+    }
+    node.radius = std::max(1.0f, std::sqrt(spread/(end-begin)));
+
+    // a billboard of size s covers an area proportional to s^2 so the
+    // aggregated color is scaled down to conserve the total energy
+    node.color = glm::vec4(color/(node.radius*node.radius), 1.0f);
+
+    for(int i = 0;i<8;++i)
+        node.children[i] = -1;
+
+    int index = nodes.size();
+    nodes.push_back(node);
+
+    if(end-begin <= 64 || depth == 12)
+        return index;
+
+    // partition into octants, first along x then y then z
+    int bounds[9];
+    bounds[0] = begin;
+    bounds[8] = end;
+    bounds[4] = std::partition(stars.begin()+bounds[0], stars.begin()+bounds[8], AxisPred(0, center.x)) - stars.begin();
+    bounds[2] = std::partition(stars.begin()+bounds[0], stars.begin()+bounds[4], AxisPred(1, center.y)) - stars.begin();
+    bounds[6] = std::partition(stars.begin()+bounds[4], stars.begin()+bounds[8], AxisPred(1, center.y)) - stars.begin();
+    bounds[1] = std::partition(stars.begin()+bounds[0], stars.begin()+bounds[2], AxisPred(2, center.z)) - stars.begin();
+    bounds[3] = std::partition(stars.begin()+bounds[2], stars.begin()+bounds[4], AxisPred(2, center.z)) - stars.begin();
+    bounds[5] = std::partition(stars.begin()+bounds[4], stars.begin()+bounds[6], AxisPred(2, center.z)) - stars.begin();
+    bounds[7] = std::partition(stars.begin()+bounds[6], stars.begin()+bounds[8], AxisPred(2, center.z)) - stars.begin();
+
+    for(int i = 0;i<8;++i) {
+        if(bounds[i] == bounds[i+1])
+            continue;
+        glm::vec3 offset(i&4?1:-1, i&2?1:-1, i&1?1:-1);
+        int child = build_octree(nodes, stars, bounds[i], bounds[i+1], center+0.5f*halfsize*offset, 0.5f*halfsize, depth+1);
+        // nodes may have been reallocated by the recursive call
+        nodes[index].children[i] = child;
+    }
+    return index;
+}
+
+// walk the octree and either emit a node as a single splat or descend
+// into it. Leaves that are close enough are drawn as individual stars.
+void collect_octree(const std::vector<Node> &nodes, int index, glm::vec3 eye, float pixelscale, float threshold,
+                    std::vector<Splat> &splats, std::vector<GLint> &firsts, std::vector<GLsizei> &counts) {
+    const Node &node = nodes[index];
+    float distance = glm::distance(eye, node.centroid);
+    float error = pixelscale*node.radius/distance;
+    if(distance > node.radius && error < threshold) {
+        Splat splat;
+        splat.position = glm::vec4(node.centroid, node.radius);
+        splat.color = node.color;
+        splats.push_back(splat);
+        return;
+    }
+
+    bool leaf = true;
+    for(int i = 0;i<8;++i) {
+        if(node.children[i] >= 0) {
+            collect_octree(nodes, node.children[i], eye, pixelscale, threshold, splats, firsts, counts);
+            leaf = false;
+        }
+    }
+
+    if(leaf) {
+        // merge with the previous range if they are adjacent
+        if(!firsts.empty() && firsts.back()+counts.back() == node.begin) {
+            counts.back() += node.end-node.begin;
+        } else {
+            firsts.push_back(node.begin);
+            counts.push_back(node.end-node.begin);
+        }
+    }
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// uniformly distributed random number in [0,1]
+float frand() {
+    return std::rand()/float(RAND_MAX);
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "15galaxy_octree_lod", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // the vertex shader simply passes through data
+    std::string vertex_source =
+        "#version 330\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 gcolor;\n"
+        "void main() {\n"
+        "   gcolor = vcolor;\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    // the geometry shader creates the billboard quads with the size
+    // stored in the w component of the position
+    std::string geometry_source =
+        "#version 330\n"
+        "uniform mat4 View;\n"
+        "uniform mat4 Projection;\n"
+        "layout (points) in;\n"
+        "layout (triangle_strip, max_vertices = 4) out;\n"
+        "in vec4 gcolor[];\n"
+        "out vec2 txcoord;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   vec4 pos = View*vec4(gl_in[0].gl_Position.xyz, 1);\n"
+        "   float size = gl_in[0].gl_Position.w;\n"
+        "   fcolor = gcolor[0];\n"
+        "   txcoord = vec2(-1,-1);\n"
+        "   gl_Position = Projection*(pos+size*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1,-1);\n"
+        "   gl_Position = Projection*(pos+size*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2(-1, 1);\n"
+        "   gl_Position = Projection*(pos+size*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1, 1);\n"
+        "   gl_Position = Projection*(pos+size*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "}\n";
+
+    // the fragment shader creates a bell like radial color distribution
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec2 txcoord;\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   float s = 0.2*(1/(1+15.*dot(txcoord, txcoord))-1/16.);\n"
+        "   FragColor = s*fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, geometry_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler geometry shader
+    geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
+    source = geometry_source.c_str();
+    length = geometry_source.size();
+    glShaderSource(geometry_shader, 1, &source, &length);
+    glCompileShader(geometry_shader);
+    if(!check_shader_compile_status(geometry_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, geometry_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint View_location = glGetUniformLocation(shader_program, "View");
+    GLint Projection_location = glGetUniformLocation(shader_program, "Projection");
+
+    const int particles = 4*1024*1024;
+
+    // create a galaxylike distribution of points
+    std::cout << "generating particles, this may take a while." << std::endl;
+    std::vector<Splat> stars(particles);
+    for(int i = 0;i<particles;++i)
+    {
+        int arm = 3*frand();
+        float alpha = 1/(0.1f+std::pow(frand(),0.7f))-1/1.1f;
+        float r = 4.0f*alpha;
+        alpha += arm*2.0f*3.1416f/3.0f;
+
+        glm::vec3 pos(r*std::sin(alpha), 0, r*std::cos(alpha));
+        pos.x += (4.0f-0.2*alpha)*(2-(frand()+frand()+frand()+frand()));
+        pos.y += (2.0f-0.1*alpha)*(2-(frand()+frand()+frand()+frand()));
+        pos.z += (4.0f-0.2*alpha)*(2-(frand()+frand()+frand()+frand()));
+
+        // yellowish core and blueish arms
+        float t = std::min(1.0f, r/20.0f);
+        stars[i].position = glm::vec4(pos, 1.0f);
+        stars[i].color = glm::vec4(glm::mix(glm::vec3(1.0f,0.9f,0.6f), glm::vec3(0.6f,0.7f,1.0f), t), 1.0f);
+    }
+
+    // build the octree, this also reorders the stars
+    std::cout << "building octree." << std::endl;
+    std::vector<Node> nodes;
+    float extent = 0.0f;
+    for(int i = 0;i<particles;++i) {
+        extent = std::max(extent, std::abs(stars[i].position.x));
+        extent = std::max(extent, std::abs(stars[i].position.y));
+        extent = std::max(extent, std::abs(stars[i].position.z));
+    }
+    build_octree(nodes, stars, 0, particles, glm::vec3(0.0f), extent, 0);
+    std::cout << nodes.size() << " octree nodes" << std::endl;
+
+    // vao and vbo handles for the stars and the aggregated splats
+    GLuint stars_vao, stars_vbo, splats_vao, splats_vbo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &stars_vao);
+    glBindVertexArray(stars_vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &stars_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, stars_vbo);
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Splat)*stars.size(), &stars[0], GL_STATIC_DRAW);
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (char*)0 + 4*sizeof(GLfloat));
+
+    // the splat buffer gets refilled every frame
+    glGenVertexArrays(1, &splats_vao);
+    glBindVertexArray(splats_vao);
+
+    glGenBuffers(1, &splats_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, splats_vbo);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 8*sizeof(GLfloat), (char*)0 + 4*sizeof(GLfloat));
+
+    // we are blending so no depth testing
+    glDisable(GL_DEPTH_TEST);
+
+    // enable blending
+    glEnable(GL_BLEND);
+    //  and set the blend function to result = 1*source + 1*destination
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    // timer query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    // containers for the per frame traversal results
+    std::vector<Splat> splats;
+    std::vector<GLint> firsts;
+    std::vector<GLsizei> counts;
+
+    // maximum projected radius of a node in pixels before it gets expanded
+    float threshold = 2.0f;
+    bool lod = true;
+    bool space_down = false;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle level of detail
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            lod = !lod;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // adjust the screen space error threshold
+        if(glfwGetKey(window, GLFW_KEY_UP)) {
+            threshold *= 1.02f;
+        }
+        if(glfwGetKey(window, GLFW_KEY_DOWN)) {
+            threshold = std::max(0.1f, threshold/1.02f);
+        }
+
+        // calculate ViewProjection matrix
+        float fov = 90.0f;
+        glm::mat4 Projection = glm::perspective(fov, 4.0f / 3.0f, 0.1f, 200.f);
+
+        // fly towards the galaxy and back out again
+        float distance = 45.0f-35.0f*std::sin(0.05f*t);
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -distance));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*std::sin(0.1f*t), glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, -22.5f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glm::vec3 eye = glm::vec3(glm::inverse(View)*glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+
+        // traverse the octree
+        splats.clear();
+        firsts.clear();
+        counts.clear();
+        if(lod) {
+            float pixelscale = 0.5f*height/std::tan(0.5f*fov*3.1416f/180.0f);
+            collect_octree(nodes, 0, eye, pixelscale, threshold, splats, firsts, counts);
+        } else {
+            firsts.push_back(0);
+            counts.push_back(particles);
+        }
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // set the uniform
+        glUniformMatrix4fv(View_location, 1, GL_FALSE, glm::value_ptr(View));
+        glUniformMatrix4fv(Projection_location, 1, GL_FALSE, glm::value_ptr(Projection));
+
+        // draw the expanded nodes as individual stars
+        glBindVertexArray(stars_vao);
+        if(!firsts.empty())
+            glMultiDrawArrays(GL_POINTS, &firsts[0], &counts[0], firsts.size());
+
+        // upload and draw the aggregated splats
+        glBindVertexArray(splats_vao);
+        if(!splats.empty()) {
+            glBindBuffer(GL_ARRAY_BUFFER, splats_vbo);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(Splat)*splats.size(), &splats[0], GL_STREAM_DRAW);
+            glDrawArrays(GL_POINTS, 0, splats.size());
+        }
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+            int drawn = 0;
+            for(size_t i = 0;i<counts.size();++i)
+                drawn += counts[i];
+            std::cout << result*1.e-6 << " ms/frame "
+                      << drawn << " stars "
+                      << splats.size() << " splats "
+                      << firsts.size() << " ranges "
+                      << "threshold " << threshold << " px" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, queries);
+
+    glDeleteVertexArrays(1, &stars_vao);
+    glDeleteBuffers(1, &stars_vbo);
+    glDeleteVertexArrays(1, &splats_vao);
+    glDeleteBuffers(1, &splats_vbo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, geometry_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(geometry_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
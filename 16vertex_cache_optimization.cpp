@@ -0,0 +1,594 @@
+/* OpenGL example code - Vertex Cache Optimization
+ *
+ * Reorders the index buffer of a mesh for the post transform vertex
+ * cache with Tom Forsyth's linear speed algorithm. Afterwards the
+ * triangles are grouped into clusters that are sorted to reduce
+ * overdraw, the vertices are reordered in the order they are first
+ * referenced to improve vertex fetch locality and the indices are
+ * narrowed to 16 bit if possible. The average cache miss ratio (ACMR,
+ * transformed vertices per triangle) and average transform to vertex
+ * ratio (ATVR, transformed vertices per unique vertex) are reported
+ * for each step using a simulated FIFO cache.
+ *
+ * switch between the index buffers with the keys 1 to 4:
+ * 1: generator order
+ * 2: randomly shuffled triangles
+ * 3: vertex cache optimized
+ * 4: vertex cache, overdraw and fetch optimized with 16 bit indices
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+// interleaved vertex format used by the mesh
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+// gpu side data of one variant of the mesh
+struct Mesh {
+    GLuint vao, vbo, ibo;
+    GLenum indextype;
+    int indexcount;
+};
+
+// count the vertex shader invocations for an index buffer by
+// simulating a FIFO post transform cache of the given size
+int count_cache_misses(const std::vector<GLuint> &indices, int vertexcount, int cachesize) {
+    std::vector<int> timestamps(vertexcount, -cachesize-1);
+    int time = 0, misses = 0;
+    for(size_t i = 0;i<indices.size();++i) {
+        if(time - timestamps[indices[i]] > cachesize) {
+            timestamps[indices[i]] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+// print ACMR and ATVR of an index buffer
+void report_cache_statistics(const char *name, const std::vector<GLuint> &indices, int vertexcount) {
+    int misses = count_cache_misses(indices, vertexcount, 16);
+    std::cout << name << ": ACMR " << float(misses)/(indices.size()/3)
+              << " ATVR " << float(misses)/vertexcount << std::endl;
+}
+
+// vertex score function from Tom Forsyth's "Linear-Speed Vertex
+// Cache Optimisation". Vertices that were used recently and
+// vertices that only have few triangles left score higher.
+const int optimizer_cachesize = 32;
+float vertex_score(int cacheposition, int remaining) {
+    if(remaining == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if(cacheposition >= 0) {
+        if(cacheposition < 3) {
+            // the vertices of the last triangle get a fixed score so
+            // the algorithm doesn't prefer strip like orders
+            score = 0.75f;
+        } else {
+            float scale = 1.0f/(optimizer_cachesize-3);
+            score = std::pow(1.0f - (cacheposition-3)*scale, 1.5f);
+        }
+    }
+    // boost vertices with few remaining triangles to avoid leaving
+    // lone triangles behind
+    score += 2.0f*std::pow(float(remaining), -0.5f);
+    return score;
+}
+
+// reorder triangles for the post transform vertex cache
+void optimize_vertex_cache(std::vector<GLuint> &indices, int vertexcount) {
+    int trianglecount = indices.size()/3;
+
+    // build vertex to triangle adjacency
+    std::vector<int> remaining(vertexcount, 0);
+    for(size_t i = 0;i<indices.size();++i)
+        ++remaining[indices[i]];
+
+    std::vector<int> offsets(vertexcount+1, 0);
+    for(int i = 0;i<vertexcount;++i)
+        offsets[i+1] = offsets[i]+remaining[i];
+
+    std::vector<int> adjacency(indices.size());
+    std::vector<int> fill(offsets.begin(), offsets.end()-1);
+    for(int i = 0;i<trianglecount;++i)
+        for(int k = 0;k<3;++k)
+            adjacency[fill[indices[3*i+k]]++] = i;
+
+    // initial scores
+    std::vector<int> cacheposition(vertexcount, -1);
+    std::vector<float> vscore(vertexcount);
+    for(int i = 0;i<vertexcount;++i)
+        vscore[i] = vertex_score(-1, remaining[i]);
+
+    std::vector<float> tscore(trianglecount);
+    std::vector<bool> emitted(trianglecount, false);
+    int best = 0;
+    for(int i = 0;i<trianglecount;++i) {
+        tscore[i] = vscore[indices[3*i+0]]+vscore[indices[3*i+1]]+vscore[indices[3*i+2]];
+        if(tscore[i] > tscore[best])
+            best = i;
+    }
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    std::vector<int> cache, newcache;
+    int scan = 0;
+
+    while(result.size() < indices.size()) {
+        // if the cache didn't provide a candidate fall back to the
+        // next triangle that wasn't emitted yet
+        if(best < 0) {
+            while(emitted[scan])
+                ++scan;
+            best = scan;
+        }
+
+        // emit the triangle and remove it from the adjacency lists
+        emitted[best] = true;
+        newcache.clear();
+        for(int k = 0;k<3;++k) {
+            int v = indices[3*best+k];
+            result.push_back(v);
+            int *begin = &adjacency[offsets[v]];
+            int *end = begin + remaining[v];
+            std::swap(*std::find(begin, end, best), *(end-1));
+            --remaining[v];
+            newcache.push_back(v);
+        }
+
+        // move the vertices of the triangle to the front of the cache
+        for(size_t i = 0;i<cache.size();++i) {
+            int v = cache[i];
+            if(v != newcache[0] && v != newcache[1] && v != newcache[2])
+                newcache.push_back(v);
+        }
+
+        // update the vertex scores including the ones that just dropped
+        // out of the cache and find the best triangle adjacent to the cache
+        best = -1;
+        float bestscore = -1.0f;
+        for(size_t i = 0;i<newcache.size();++i) {
+            int v = newcache[i];
+            cacheposition[v] = int(i) < optimizer_cachesize ? int(i) : -1;
+            vscore[v] = vertex_score(cacheposition[v], remaining[v]);
+        }
+        for(size_t i = 0;i<newcache.size();++i) {
+            int v = newcache[i];
+            for(int j = 0;j<remaining[v];++j) {
+                int t = adjacency[offsets[v]+j];
+                tscore[t] = vscore[indices[3*t+0]]+vscore[indices[3*t+1]]+vscore[indices[3*t+2]];
+                if(tscore[t] > bestscore) {
+                    bestscore = tscore[t];
+                    best = t;
+                }
+            }
+        }
+
+        if(newcache.size() > size_t(optimizer_cachesize))
+            newcache.resize(optimizer_cachesize);
+        cache.swap(newcache);
+    }
+
+    indices.swap(result);
+}
+
+// predicate to sort clusters by their overdraw sort key
+class ClusterPred {
+public:
+    ClusterPred(const std::vector<float> &k) : keys(k) { }
+    bool operator()(int a, int b) {
+        return keys[a] > keys[b];
+    }
+private:
+    const std::vector<float> &keys;
+};
+
+// split the index buffer into clusters and sort them so that clusters
+// facing away from the mesh center are drawn first. These are likely to
+// occlude the rest of the mesh which reduces overdraw. Clusters are
+// small compared to the mesh so the cache efficiency mostly survives.
+void optimize_overdraw(const std::vector<Vertex> &vertices, std::vector<GLuint> &indices, int clustersize) {
+    int trianglecount = indices.size()/3;
+    int clustercount = (trianglecount+clustersize-1)/clustersize;
+
+    glm::vec3 meshcenter(0.0f);
+    for(size_t i = 0;i<vertices.size();++i)
+        meshcenter += vertices[i].position;
+    meshcenter /= float(vertices.size());
+
+    std::vector<float> keys(clustercount);
+    std::vector<int> order(clustercount);
+    for(int c = 0;c<clustercount;++c) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        int end = std::min(trianglecount, (c+1)*clustersize);
+        for(int t = c*clustersize;t<end;++t) {
+            glm::vec3 a = vertices[indices[3*t+0]].position;
+            glm::vec3 b = vertices[indices[3*t+1]].position;
+            glm::vec3 d = vertices[indices[3*t+2]].position;
+            centroid += a+b+d;
+            normal += glm::cross(b-a, d-a);
+        }
+        centroid /= float(3*(end-c*clustersize));
+        keys[c] = glm::dot(centroid-meshcenter, glm::normalize(normal));
+        order[c] = c;
+    }
+
+    std::sort(order.begin(), order.end(), ClusterPred(keys));
+
+    std::vector<GLuint> result;
+    result.reserve(indices.size());
+    for(int c = 0;c<clustercount;++c) {
+        int begin = 3*order[c]*clustersize;
+        int end = std::min<int>(indices.size(), begin+3*clustersize);
+        result.insert(result.end(), indices.begin()+begin, indices.begin()+end);
+    }
+    indices.swap(result);
+}
+
+// renumber the vertices in the order they are first referenced so the
+// vertex fetch walks through memory linearly
+void optimize_vertex_fetch(std::vector<Vertex> &vertices, std::vector<GLuint> &indices) {
+    std::vector<int> remap(vertices.size(), -1);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+    for(size_t i = 0;i<indices.size();++i) {
+        if(remap[indices[i]] < 0) {
+            remap[indices[i]] = result.size();
+            result.push_back(vertices[indices[i]]);
+        }
+        indices[i] = remap[indices[i]];
+    }
+    vertices.swap(result);
+}
+
+// upload vertices and indices, narrowing the indices to 16 bit if allowed
+Mesh create_mesh(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, bool narrow) {
+    Mesh mesh;
+    mesh.indexcount = indices.size();
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &mesh.vao);
+    glBindVertexArray(mesh.vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &mesh.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex)*vertices.size(), &vertices[0], GL_STATIC_DRAW);
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &mesh.ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+
+    if(narrow && vertices.size() <= 65536) {
+        std::vector<GLushort> narrowed(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort)*narrowed.size(), &narrowed[0], GL_STATIC_DRAW);
+        mesh.indextype = GL_UNSIGNED_SHORT;
+    } else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indices.size(), &indices[0], GL_STATIC_DRAW);
+        mesh.indextype = GL_UNSIGNED_INT;
+    }
+
+    glBindVertexArray(0);
+    return mesh;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "16vertex_cache_optimization", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    // the instances are arranged in a 4x4 grid
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   vec4 offset = vec4(3*(gl_InstanceID%4)-4.5, 3*(gl_InstanceID/4)-4.5, 0, 0);\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*(vposition+offset);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+
+    // generate a torus, with 512x128 vertices it just fits 16 bit indices
+    const int major = 512, minor = 128;
+    std::vector<Vertex> vertices(major*minor);
+    for(int i = 0;i<major;++i) {
+        float phi = 2.0f*3.1416f*i/major;
+        glm::vec3 center(std::cos(phi), std::sin(phi), 0.0f);
+        for(int j = 0;j<minor;++j) {
+            float theta = 2.0f*3.1416f*j/minor;
+            glm::vec3 normal = std::cos(theta)*center + glm::vec3(0.0f, 0.0f, std::sin(theta));
+            vertices[i*minor+j].position = center + 0.4f*normal;
+            vertices[i*minor+j].normal = normal;
+        }
+    }
+
+    // two triangles per quad in generator order
+    std::vector<GLuint> indices;
+    for(int i = 0;i<major;++i) {
+        for(int j = 0;j<minor;++j) {
+            GLuint a = i*minor+j;
+            GLuint b = i*minor+(j+1)%minor;
+            GLuint c = ((i+1)%major)*minor+j;
+            GLuint d = ((i+1)%major)*minor+(j+1)%minor;
+            indices.push_back(a); indices.push_back(c); indices.push_back(b);
+            indices.push_back(b); indices.push_back(c); indices.push_back(d);
+        }
+    }
+    report_cache_statistics("generator order", indices, vertices.size());
+
+    // randomly shuffle the triangles to simulate an unfriendly generator
+    std::vector<GLuint> shuffled(indices.size());
+    std::vector<int> order(indices.size()/3);
+    for(size_t i = 0;i<order.size();++i)
+        order[i] = i;
+    std::random_shuffle(order.begin(), order.end());
+    for(size_t i = 0;i<order.size();++i)
+        for(int k = 0;k<3;++k)
+            shuffled[3*i+k] = indices[3*order[i]+k];
+    report_cache_statistics("shuffled", shuffled, vertices.size());
+
+    // vertex cache optimization
+    double start = glfwGetTime();
+    std::vector<GLuint> optimized = shuffled;
+    optimize_vertex_cache(optimized, vertices.size());
+    std::cout << "vertex cache optimization took " << 1000.0*(glfwGetTime()-start) << " ms" << std::endl;
+    report_cache_statistics("vertex cache optimized", optimized, vertices.size());
+
+    // overdraw and fetch optimization on top of that
+    std::vector<Vertex> fetch_vertices = vertices;
+    std::vector<GLuint> fetch_optimized = optimized;
+    optimize_overdraw(fetch_vertices, fetch_optimized, 256);
+    report_cache_statistics("overdraw optimized", fetch_optimized, vertices.size());
+    optimize_vertex_fetch(fetch_vertices, fetch_optimized);
+
+    // upload all variants
+    const int meshcount = 4;
+    Mesh meshes[meshcount];
+    meshes[0] = create_mesh(vertices, indices, false);
+    meshes[1] = create_mesh(vertices, shuffled, false);
+    meshes[2] = create_mesh(vertices, optimized, false);
+    meshes[3] = create_mesh(fetch_vertices, fetch_optimized, true);
+
+    const char *names[meshcount] = {
+        "generator order", "shuffled", "vertex cache optimized", "fully optimized 16 bit"
+    };
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // timer query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int query_mesh[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    int current_mesh = 0;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // select the mesh variant
+        for(int i = 0;i<meshcount;++i) {
+            if(glfwGetKey(window, '1'+i)) {
+                current_mesh = i;
+            }
+        }
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 20.0f*std::sin(0.5f*t), glm::vec3(1.0f, 1.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        // bind the vao
+        glBindVertexArray(meshes[current_mesh].vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, meshes[current_mesh].indexcount, meshes[current_mesh].indextype, 0, 16);
+
+        glEndQuery(GL_TIME_ELAPSED);
+        query_mesh[current_query] = current_mesh;
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+            std::cout << result*1.e-6 << " ms/frame " << names[query_mesh[(current_query+1)%querycount]] << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, queries);
+
+    for(int i = 0;i<meshcount;++i) {
+        glDeleteVertexArrays(1, &meshes[i].vao);
+        glDeleteBuffers(1, &meshes[i].vbo);
+        glDeleteBuffers(1, &meshes[i].ibo);
+    }
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
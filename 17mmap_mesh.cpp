@@ -0,0 +1,917 @@
+/* OpenGL example code - Memory Mapped Binary Mesh
+ *
+ * Stores meshes in a compact binary container with page aligned vertex,
+ * index and meshlet blobs plus attribute descriptors. Loading maps the
+ * file with mmap and passes the blobs straight to glBufferData so no
+ * parsing or copying happens on the CPU and the load time is bound by
+ * the disk bandwidth. The example also contains a converter from
+ * Wavefront OBJ and PLY (ascii and binary little endian) files.
+ *
+ * usage:
+ *   17mmap_mesh input.obj|input.ply output.mesh   convert and view
+ *   17mmap_mesh input.mesh                        view
+ *   17mmap_mesh                                   generate torus.mesh and view
+ *
+ * toggle the meshlet visualization with space
+ *
+ * The container uses the native (little endian) byte order and the
+ * loader uses the POSIX mmap interface.
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// blobs start at page boundaries so they can be mapped and
+// prefetched independently
+const size_t mesh_alignment = 4096;
+const GLuint mesh_version = 1;
+
+// describes one vertex attribute inside the interleaved vertex blob
+struct MeshAttribute {
+    GLuint location;
+    GLuint components;
+    GLenum type;
+    GLuint normalized;
+    GLuint offset;
+};
+
+// a meshlet is a contiguous range of the index blob that references at
+// most 64 unique vertices and contains at most 124 triangles
+struct Meshlet {
+    GLuint indexoffset;
+    GLuint indexcount;
+    float center[3];
+    float radius;
+};
+
+// file header, all offsets are in bytes from the start of the file
+struct MeshHeader {
+    char magic[4];
+    GLuint version;
+    GLuint vertexcount;
+    GLuint vertexstride;
+    GLuint indexcount;
+    GLenum indextype;
+    GLuint meshletcount;
+    GLuint attributecount;
+    MeshAttribute attributes[8];
+    unsigned long long vertexoffset;
+    unsigned long long indexoffset;
+    unsigned long long meshletoffset;
+    unsigned long long filesize;
+    float center[3];
+    float radius;
+};
+
+// vertex format produced by the converter
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+// memory mapped mesh file
+struct MappedMesh {
+    int fd;
+    size_t size;
+    const char *data;
+    const MeshHeader *header;
+};
+
+// bounding sphere around a set of points, the center of the bounding
+// box is used as center which is good enough for culling
+void bounding_sphere(const std::vector<glm::vec3> &points, float *center, float *radius) {
+    glm::vec3 lo = points[0], hi = points[0];
+    for(size_t i = 1;i<points.size();++i) {
+        lo = glm::min(lo, points[i]);
+        hi = glm::max(hi, points[i]);
+    }
+    glm::vec3 c = 0.5f*(lo+hi);
+    float r = 0.0f;
+    for(size_t i = 0;i<points.size();++i)
+        r = std::max(r, glm::distance(c, points[i]));
+    center[0] = c.x; center[1] = c.y; center[2] = c.z;
+    *radius = r;
+}
+
+// greedily split the index buffer into meshlets in the existing
+// triangle order, so a cache optimized index order gives tight meshlets
+void build_meshlets(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, std::vector<Meshlet> &meshlets) {
+    const size_t max_vertices = 64, max_triangles = 124;
+    std::vector<GLuint> unique;
+    std::vector<glm::vec3> points;
+    Meshlet meshlet;
+    meshlet.indexoffset = 0;
+    meshlet.indexcount = 0;
+    for(size_t i = 0;i<=indices.size();i+=3) {
+        // count vertices the next triangle would add
+        size_t added = 0;
+        if(i<indices.size())
+            for(int k = 0;k<3;++k)
+                if(std::find(unique.begin(), unique.end(), indices[i+k]) == unique.end())
+                    ++added;
+
+        // close the current meshlet if it is full or we are done
+        if(i == indices.size() || unique.size()+added > max_vertices || meshlet.indexcount/3 == max_triangles) {
+            if(meshlet.indexcount == 0)
+                break;
+            points.clear();
+            for(size_t j = 0;j<unique.size();++j)
+                points.push_back(vertices[unique[j]].position);
+            bounding_sphere(points, meshlet.center, &meshlet.radius);
+            meshlets.push_back(meshlet);
+            if(i == indices.size())
+                break;
+            meshlet.indexoffset = i;
+            meshlet.indexcount = 0;
+            unique.clear();
+        }
+
+        for(int k = 0;k<3;++k)
+            if(std::find(unique.begin(), unique.end(), indices[i+k]) == unique.end())
+                unique.push_back(indices[i+k]);
+        meshlet.indexcount += 3;
+    }
+}
+
+// compute area weighted vertex normals
+void compute_normals(std::vector<Vertex> &vertices, const std::vector<GLuint> &indices) {
+    for(size_t i = 0;i<vertices.size();++i)
+        vertices[i].normal = glm::vec3(0.0f);
+    for(size_t i = 0;i<indices.size();i+=3) {
+        glm::vec3 a = vertices[indices[i+0]].position;
+        glm::vec3 b = vertices[indices[i+1]].position;
+        glm::vec3 c = vertices[indices[i+2]].position;
+        glm::vec3 n = glm::cross(b-a, c-a);
+        for(int k = 0;k<3;++k)
+            vertices[indices[i+k]].normal += n;
+    }
+    for(size_t i = 0;i<vertices.size();++i)
+        if(glm::length(vertices[i].normal) > 0.0f)
+            vertices[i].normal = glm::normalize(vertices[i].normal);
+}
+
+// resolve a possibly negative (relative) obj index, returns false
+// if it doesn't refer to one of the count elements read so far
+bool obj_index(const std::string &token, int count, int &index) {
+    int value = std::atoi(token.c_str());
+    index = value < 0 ? count+value : value-1;
+    return value != 0 && index >= 0 && index < count;
+}
+
+// load positions, normals and faces from a Wavefront OBJ file,
+// polygons are triangulated as fans
+bool load_obj(const char *filename, std::vector<Vertex> &vertices, std::vector<GLuint> &indices) {
+    std::ifstream file(filename);
+    if(!file) {
+        std::cerr << "failed to open " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> positions, normals;
+    std::map<std::pair<int,int>, GLuint> lookup;
+    int texcoordcount = 0;
+    bool has_normals = true;
+    std::string line;
+    for(int linenumber = 1;std::getline(file, line);++linenumber) {
+        std::istringstream in(line);
+        std::string type;
+        in >> type;
+        if(type == "v") {
+            glm::vec3 p;
+            in >> p.x >> p.y >> p.z;
+            positions.push_back(p);
+        } else if(type == "vn") {
+            glm::vec3 n;
+            in >> n.x >> n.y >> n.z;
+            normals.push_back(n);
+        } else if(type == "vt") {
+            ++texcoordcount;
+        } else if(type == "f") {
+            std::vector<GLuint> polygon;
+            std::string corner;
+            while(in >> corner) {
+                // corners are v, v/vt, v//vn or v/vt/vn
+                std::string::size_type first = corner.find('/');
+                std::string::size_type last = corner.rfind('/');
+                int v, t, n = -1;
+                bool valid = obj_index(corner.substr(0, first), positions.size(), v);
+                if(valid && first != std::string::npos) {
+                    std::string::size_type end = last != first ? last : std::string::npos;
+                    std::string texcoord = corner.substr(first+1, end == std::string::npos ? end : end-first-1);
+                    if(!texcoord.empty())
+                        valid = obj_index(texcoord, texcoordcount, t);
+                }
+                if(valid && first != std::string::npos && last != first)
+                    valid = obj_index(corner.substr(last+1), normals.size(), n);
+                if(!valid) {
+                    std::cerr << filename << ":" << linenumber << ": invalid index in face corner " << corner << std::endl;
+                    return false;
+                }
+                if(n < 0)
+                    has_normals = false;
+
+                std::pair<int,int> key(v, n);
+                std::map<std::pair<int,int>, GLuint>::iterator found = lookup.find(key);
+                if(found == lookup.end()) {
+                    Vertex vertex;
+                    vertex.position = positions[v];
+                    vertex.normal = n < 0 ? glm::vec3(0.0f) : normals[n];
+                    found = lookup.insert(std::make_pair(key, GLuint(vertices.size()))).first;
+                    vertices.push_back(vertex);
+                }
+                polygon.push_back(found->second);
+            }
+            for(size_t i = 2;i<polygon.size();++i) {
+                indices.push_back(polygon[0]);
+                indices.push_back(polygon[i-1]);
+                indices.push_back(polygon[i]);
+            }
+        }
+    }
+
+    if(!has_normals)
+        compute_normals(vertices, indices);
+    return true;
+}
+
+// read one scalar of the given ply type from an ascii or binary stream
+double read_ply_value(std::istream &in, const std::string &type, bool ascii) {
+    if(ascii) {
+        double value;
+        in >> value;
+        return value;
+    }
+    if(type == "char" || type == "int8") { signed char v; in.read((char*)&v, 1); return v; }
+    if(type == "uchar" || type == "uint8") { unsigned char v; in.read((char*)&v, 1); return v; }
+    if(type == "short" || type == "int16") { short v; in.read((char*)&v, 2); return v; }
+    if(type == "ushort" || type == "uint16") { unsigned short v; in.read((char*)&v, 2); return v; }
+    if(type == "int" || type == "int32") { int v; in.read((char*)&v, 4); return v; }
+    if(type == "uint" || type == "uint32") { unsigned v; in.read((char*)&v, 4); return v; }
+    if(type == "float" || type == "float32") { float v; in.read((char*)&v, 4); return v; }
+    double v; in.read((char*)&v, 8); return v;
+}
+
+// a property of a ply element, list properties have a count type
+struct PlyProperty {
+    std::string name, type, counttype;
+    bool list;
+};
+
+// load the vertex and face elements of an ascii or binary little
+// endian PLY file, other elements are skipped
+bool load_ply(const char *filename, std::vector<Vertex> &vertices, std::vector<GLuint> &indices) {
+    std::ifstream file(filename, std::ios::binary);
+    if(!file) {
+        std::cerr << "failed to open " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> elements;
+    std::vector<int> counts;
+    std::vector<std::vector<PlyProperty> > properties;
+    bool ascii = true;
+
+    // parse header
+    std::string line;
+    size_t headerlines = 0;
+    while(std::getline(file, line)) {
+        ++headerlines;
+        std::istringstream in(line);
+        std::string keyword;
+        in >> keyword;
+        if(keyword == "format") {
+            std::string format;
+            in >> format;
+            if(format == "binary_big_endian") {
+                std::cerr << "big endian ply files are not supported" << std::endl;
+                return false;
+            }
+            ascii = format == "ascii";
+        } else if(keyword == "element") {
+            std::string name;
+            int count;
+            in >> name >> count;
+            elements.push_back(name);
+            counts.push_back(count);
+            properties.push_back(std::vector<PlyProperty>());
+        } else if(keyword == "property" && !properties.empty()) {
+            PlyProperty property;
+            in >> property.type;
+            property.list = property.type == "list";
+            if(property.list)
+                in >> property.counttype >> property.type;
+            in >> property.name;
+            properties.back().push_back(property);
+        } else if(keyword == "end_header") {
+            break;
+        }
+    }
+
+    // faces may come before the vertices, so check indices against
+    // the declared vertex count
+    int vertexcount = 0;
+    for(size_t e = 0;e<elements.size();++e)
+        if(elements[e] == "vertex")
+            vertexcount = counts[e];
+
+    bool has_normals = false;
+    for(size_t e = 0, linenumber = headerlines+1;e<elements.size();++e) {
+        for(int i = 0;i<counts[e];++i, ++linenumber) {
+            Vertex vertex;
+            vertex.position = glm::vec3(0.0f);
+            vertex.normal = glm::vec3(0.0f);
+            std::vector<GLuint> polygon;
+            for(size_t p = 0;p<properties[e].size();++p) {
+                const PlyProperty &property = properties[e][p];
+                if(property.list) {
+                    int n = read_ply_value(file, property.counttype, ascii);
+                    for(int j = 0;j<n;++j) {
+                        double index = read_ply_value(file, property.type, ascii);
+                        if(elements[e] == "face" && file && !(index >= 0 && index < vertexcount)) {
+                            std::cerr << filename;
+                            if(ascii)
+                                std::cerr << ":" << linenumber;
+                            std::cerr << ": face " << i << " has invalid vertex index " << index << std::endl;
+                            return false;
+                        }
+                        polygon.push_back(index);
+                    }
+                    continue;
+                }
+                float value = read_ply_value(file, property.type, ascii);
+                if(property.name == "x") vertex.position.x = value;
+                if(property.name == "y") vertex.position.y = value;
+                if(property.name == "z") vertex.position.z = value;
+                if(property.name == "nx") { vertex.normal.x = value; has_normals = true; }
+                if(property.name == "ny") vertex.normal.y = value;
+                if(property.name == "nz") vertex.normal.z = value;
+            }
+            if(elements[e] == "vertex") {
+                vertices.push_back(vertex);
+            } else if(elements[e] == "face") {
+                for(size_t j = 2;j<polygon.size();++j) {
+                    indices.push_back(polygon[0]);
+                    indices.push_back(polygon[j-1]);
+                    indices.push_back(polygon[j]);
+                }
+            }
+        }
+    }
+
+    if(!file) {
+        std::cerr << "unexpected end of " << filename << std::endl;
+        return false;
+    }
+
+    if(!has_normals)
+        compute_normals(vertices, indices);
+    return true;
+}
+
+// pad the stream with zeros up to the next multiple of the alignment
+void write_padding(std::ofstream &out) {
+    static const char zeros[mesh_alignment] = {0};
+    size_t position = out.tellp();
+    size_t padding = (mesh_alignment - position%mesh_alignment)%mesh_alignment;
+    out.write(zeros, padding);
+}
+
+// write vertices, indices and meshlets into the binary container
+bool write_mesh(const char *filename, const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices) {
+    std::vector<Meshlet> meshlets;
+    build_meshlets(vertices, indices, meshlets);
+
+    MeshHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "MESH", 4);
+    header.version = mesh_version;
+    header.vertexcount = vertices.size();
+    header.vertexstride = sizeof(Vertex);
+    header.indexcount = indices.size();
+    header.meshletcount = meshlets.size();
+
+    header.attributecount = 2;
+    header.attributes[0].location = 0;
+    header.attributes[0].components = 3;
+    header.attributes[0].type = GL_FLOAT;
+    header.attributes[0].normalized = GL_FALSE;
+    header.attributes[0].offset = 0;
+    header.attributes[1].location = 1;
+    header.attributes[1].components = 3;
+    header.attributes[1].type = GL_FLOAT;
+    header.attributes[1].normalized = GL_FALSE;
+    header.attributes[1].offset = 3*sizeof(GLfloat);
+
+    // narrow the indices if possible
+    size_t indexsize;
+    if(vertices.size() <= 65536) {
+        header.indextype = GL_UNSIGNED_SHORT;
+        indexsize = sizeof(GLushort);
+    } else {
+        header.indextype = GL_UNSIGNED_INT;
+        indexsize = sizeof(GLuint);
+    }
+
+    std::vector<glm::vec3> points(vertices.size());
+    for(size_t i = 0;i<vertices.size();++i)
+        points[i] = vertices[i].position;
+    bounding_sphere(points, header.center, &header.radius);
+
+    // compute blob offsets
+    size_t offset = sizeof(MeshHeader);
+    offset = (offset+mesh_alignment-1)/mesh_alignment*mesh_alignment;
+    header.vertexoffset = offset;
+    offset += vertices.size()*sizeof(Vertex);
+    offset = (offset+mesh_alignment-1)/mesh_alignment*mesh_alignment;
+    header.indexoffset = offset;
+    offset += indices.size()*indexsize;
+    offset = (offset+mesh_alignment-1)/mesh_alignment*mesh_alignment;
+    header.meshletoffset = offset;
+    offset += meshlets.size()*sizeof(Meshlet);
+    header.filesize = offset;
+
+    std::ofstream out(filename, std::ios::binary);
+    if(!out) {
+        std::cerr << "failed to open " << filename << " for writing" << std::endl;
+        return false;
+    }
+    out.write((const char*)&header, sizeof(header));
+    write_padding(out);
+    out.write((const char*)&vertices[0], vertices.size()*sizeof(Vertex));
+    write_padding(out);
+    if(header.indextype == GL_UNSIGNED_SHORT) {
+        std::vector<GLushort> narrowed(indices.begin(), indices.end());
+        out.write((const char*)&narrowed[0], narrowed.size()*indexsize);
+    } else {
+        out.write((const char*)&indices[0], indices.size()*indexsize);
+    }
+    write_padding(out);
+    out.write((const char*)&meshlets[0], meshlets.size()*sizeof(Meshlet));
+
+    std::cout << "wrote " << filename << ": " << vertices.size() << " vertices, "
+              << indices.size()/3 << " triangles, " << meshlets.size() << " meshlets" << std::endl;
+    return !out.fail();
+}
+
+// true if count elements of the given stride starting at offset fit
+// into size bytes, written so the multiplication can't overflow
+bool range_inside(unsigned long long offset, unsigned long long count, unsigned long long stride, unsigned long long size) {
+    if(offset > size)
+        return false;
+    if(stride != 0 && count > (size-offset)/stride)
+        return false;
+    return true;
+}
+
+// size of one component of a vertex attribute type, 0 if the type
+// isn't supported
+size_t attribute_type_size(GLenum type) {
+    switch(type) {
+        case GL_BYTE: case GL_UNSIGNED_BYTE: return 1;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: return 2;
+        case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT: return 4;
+        default: return 0;
+    }
+}
+
+// true if all count indices in data are below limit, the index blob
+// has no alignment guarantee so the values are copied out
+template<class T>
+bool indices_below(const char *data, GLuint count, GLuint limit) {
+    for(GLuint i = 0;i<count;++i) {
+        T index;
+        std::memcpy(&index, data + i*sizeof(T), sizeof(T));
+        if(index >= limit)
+            return false;
+    }
+    return true;
+}
+
+// check that everything the header points to lies inside the mapping
+// and that the indices only reference existing vertices, returns a
+// description of the first problem or 0
+const char* validate_mesh(const MappedMesh &mesh) {
+    const MeshHeader &header = *mesh.header;
+    if(header.filesize > mesh.size)
+        return "file is truncated";
+    if(header.attributecount > 8)
+        return "too many attributes";
+    if(header.vertexstride == 0)
+        return "invalid vertex stride";
+    for(GLuint i = 0;i<header.attributecount;++i) {
+        const MeshAttribute &attribute = header.attributes[i];
+        size_t typesize = attribute_type_size(attribute.type);
+        if(attribute.location >= 16 || attribute.components < 1 || attribute.components > 4 || typesize == 0 ||
+           attribute.offset > header.vertexstride || attribute.components*typesize > header.vertexstride-attribute.offset)
+            return "invalid attribute";
+    }
+    if(header.indextype != GL_UNSIGNED_SHORT && header.indextype != GL_UNSIGNED_INT)
+        return "invalid index type";
+    size_t indexsize = header.indextype == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    if(!range_inside(header.vertexoffset, header.vertexcount, header.vertexstride, mesh.size))
+        return "vertex data out of range";
+    if(!range_inside(header.indexoffset, header.indexcount, indexsize, mesh.size))
+        return "index data out of range";
+    if(!range_inside(header.meshletoffset, header.meshletcount, sizeof(Meshlet), mesh.size))
+        return "meshlet table out of range";
+    const Meshlet *meshlets = reinterpret_cast<const Meshlet*>(mesh.data+header.meshletoffset);
+    for(GLuint i = 0;i<header.meshletcount;++i)
+        if(!range_inside(meshlets[i].indexoffset, meshlets[i].indexcount, 1, header.indexcount))
+            return "meshlet index range out of range";
+    const char *indices = mesh.data+header.indexoffset;
+    if(header.indextype == GL_UNSIGNED_SHORT ? !indices_below<GLushort>(indices, header.indexcount, header.vertexcount)
+                                             : !indices_below<GLuint>(indices, header.indexcount, header.vertexcount))
+        return "index references a missing vertex";
+    return 0;
+}
+
+// map a mesh file into memory and validate the header
+bool map_mesh(const char *filename, MappedMesh &mesh) {
+    mesh.fd = open(filename, O_RDONLY);
+    if(mesh.fd < 0) {
+        std::cerr << "failed to open " << filename << std::endl;
+        return false;
+    }
+
+    struct stat info;
+    if(fstat(mesh.fd, &info) != 0 || info.st_size < off_t(sizeof(MeshHeader))) {
+        std::cerr << filename << " is not a valid mesh file" << std::endl;
+        close(mesh.fd);
+        return false;
+    }
+    mesh.size = info.st_size;
+
+    void *data = mmap(0, mesh.size, PROT_READ, MAP_PRIVATE, mesh.fd, 0);
+    if(data == MAP_FAILED) {
+        std::cerr << "failed to map " << filename << std::endl;
+        close(mesh.fd);
+        return false;
+    }
+    mesh.data = static_cast<const char*>(data);
+    mesh.header = reinterpret_cast<const MeshHeader*>(mesh.data);
+
+    // we are going to read the whole file front to back
+    madvise(data, mesh.size, MADV_SEQUENTIAL);
+    madvise(data, mesh.size, MADV_WILLNEED);
+
+    if(std::memcmp(mesh.header->magic, "MESH", 4) != 0 || mesh.header->version != mesh_version) {
+        std::cerr << filename << " is not a valid mesh file" << std::endl;
+        munmap(data, mesh.size);
+        close(mesh.fd);
+        return false;
+    }
+
+    const char *error = validate_mesh(mesh);
+    if(error) {
+        std::cerr << filename << ": " << error << std::endl;
+        munmap(data, mesh.size);
+        close(mesh.fd);
+        return false;
+    }
+    return true;
+}
+
+void unmap_mesh(MappedMesh &mesh) {
+    munmap(const_cast<char*>(mesh.data), mesh.size);
+    close(mesh.fd);
+}
+
+// generate a torus as a default mesh
+void generate_torus(std::vector<Vertex> &vertices, std::vector<GLuint> &indices) {
+    const int major = 256, minor = 64;
+    for(int i = 0;i<major;++i) {
+        float phi = 2.0f*3.1416f*i/major;
+        glm::vec3 center(std::cos(phi), std::sin(phi), 0.0f);
+        for(int j = 0;j<minor;++j) {
+            float theta = 2.0f*3.1416f*j/minor;
+            Vertex vertex;
+            vertex.normal = std::cos(theta)*center + glm::vec3(0.0f, 0.0f, std::sin(theta));
+            vertex.position = center + 0.4f*vertex.normal;
+            vertices.push_back(vertex);
+        }
+    }
+    for(int i = 0;i<major;++i) {
+        for(int j = 0;j<minor;++j) {
+            GLuint a = i*minor+j;
+            GLuint b = i*minor+(j+1)%minor;
+            GLuint c = ((i+1)%major)*minor+j;
+            GLuint d = ((i+1)%major)*minor+(j+1)%minor;
+            indices.push_back(a); indices.push_back(c); indices.push_back(b);
+            indices.push_back(b); indices.push_back(c); indices.push_back(d);
+        }
+    }
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int width = 640;
+    int height = 480;
+
+    // convert or generate the input first, this doesn't need a context
+    std::string meshfile;
+    if(argc >= 3) {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        std::string input = argv[1];
+        bool loaded;
+        if(input.size() > 4 && input.substr(input.size()-4) == ".ply")
+            loaded = load_ply(argv[1], vertices, indices);
+        else
+            loaded = load_obj(argv[1], vertices, indices);
+        if(!loaded || indices.empty() || !write_mesh(argv[2], vertices, indices))
+            return 1;
+        meshfile = argv[2];
+    } else if(argc == 2) {
+        meshfile = argv[1];
+    } else {
+        std::vector<Vertex> vertices;
+        std::vector<GLuint> indices;
+        generate_torus(vertices, indices);
+        if(!write_mesh("torus.mesh", vertices, indices))
+            return 1;
+        meshfile = "torus.mesh";
+    }
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "17mmap_mesh", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "uniform vec3 color;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness*color,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint color_location = glGetUniformLocation(shader_program, "color");
+
+    // map the mesh file
+    double start = glfwGetTime();
+    MappedMesh mesh;
+    if(!map_mesh(meshfile.c_str(), mesh)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+    const MeshHeader &header = *mesh.header;
+    double mapped = glfwGetTime();
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // fill directly from the mapped file
+    glBufferData(GL_ARRAY_BUFFER, size_t(header.vertexcount)*header.vertexstride, mesh.data+header.vertexoffset, GL_STATIC_DRAW);
+
+    // set up generic attrib pointers from the attribute descriptors
+    for(GLuint i = 0;i<header.attributecount;++i) {
+        const MeshAttribute &attribute = header.attributes[i];
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type,
+                              attribute.normalized, header.vertexstride, (char*)0 + attribute.offset);
+    }
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    size_t indexsize = header.indextype == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, header.indexcount*indexsize, mesh.data+header.indexoffset, GL_STATIC_DRAW);
+
+    // the meshlet table is small and used on the CPU, so it is read
+    // straight from the mapping as well
+    const Meshlet *meshlets = reinterpret_cast<const Meshlet*>(mesh.data+header.meshletoffset);
+
+    // wait for the upload to finish so the timing is meaningful
+    glFinish();
+    double uploaded = glfwGetTime();
+
+    std::cout << "mapped " << mesh.size/(1024.0*1024.0) << " MB in " << 1000.0*(mapped-start) << " ms, "
+              << "uploaded in " << 1000.0*(uploaded-mapped) << " ms ("
+              << mesh.size/(1024.0*1024.0)/(uploaded-start) << " MB/s)" << std::endl;
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+
+    bool show_meshlets = false;
+    bool space_down = false;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle meshlet visualization
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            show_meshlets = !show_meshlets;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.01f*header.radius, 10.0f*header.radius);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f*header.radius));
+
+        // make the camera rotate around the center of the mesh
+        View = glm::rotate(View, 30.0f*t, glm::vec3(1.0f, 1.0f, 1.0f));
+        View = glm::translate(View, -glm::vec3(header.center[0], header.center[1], header.center[2]));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        if(show_meshlets) {
+            // one draw per meshlet with a pseudo random color
+            for(GLuint i = 0;i<header.meshletcount;++i) {
+                glUniform3f(color_location, (i*37%255)/255.0f, (i*91%255)/255.0f, (i*173%255)/255.0f);
+                glDrawElements(GL_TRIANGLES, meshlets[i].indexcount, header.indextype, (char*)0 + meshlets[i].indexoffset*indexsize);
+            }
+        } else {
+            glUniform3f(color_location, 1.0f, 1.0f, 1.0f);
+            glDrawElements(GL_TRIANGLES, header.indexcount, header.indextype, 0);
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    unmap_mesh(mesh);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,553 @@
+/* OpenGL example code - Meshlet Culling
+ *
+ * Splits a dense mesh into small clusters (meshlets) of at most 64
+ * vertices and 124 triangles and stores a bounding sphere and a normal
+ * cone for each of them. A compute shader tests every meshlet against
+ * the view frustum and its normal cone against the view direction and
+ * writes one glMultiDrawElementsIndirect command per meshlet. Culled
+ * meshlets get an instance count of zero. This rejects hidden geometry
+ * at a much finer granularity than per object culling.
+ *
+ * toggle culling with space
+ *
+ * This example requires at least OpenGL 4.3
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// interleaved vertex format used by the mesh
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+// meshlet layout as seen by the culling shader (std430)
+// sphere = center, radius
+// cone = axis, sin of the cone half angle (>1 disables the cone test)
+struct Meshlet {
+    glm::vec4 sphere;
+    glm::vec4 cone;
+    GLuint indexoffset;
+    GLuint indexcount;
+    GLuint padding[2];
+};
+
+// layout of the commands consumed by glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLuint baseVertex;
+    GLuint baseInstance;
+};
+
+// compute bounding sphere and normal cone of the triangles in [begin, end)
+Meshlet meshlet_bounds(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, size_t begin, size_t end) {
+    Meshlet meshlet;
+    meshlet.indexoffset = begin;
+    meshlet.indexcount = end-begin;
+    meshlet.padding[0] = meshlet.padding[1] = 0;
+
+    // bounding box center as sphere center
+    glm::vec3 lo = vertices[indices[begin]].position, hi = lo;
+    for(size_t i = begin;i<end;++i) {
+        lo = glm::min(lo, vertices[indices[i]].position);
+        hi = glm::max(hi, vertices[indices[i]].position);
+    }
+    glm::vec3 center = 0.5f*(lo+hi);
+    float radius = 0.0f;
+    for(size_t i = begin;i<end;++i)
+        radius = std::max(radius, glm::distance(center, vertices[indices[i]].position));
+    meshlet.sphere = glm::vec4(center, radius);
+
+    // the cone axis is the average triangle normal and the cone angle
+    // is the largest deviation from it
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis(0.0f);
+    for(size_t i = begin;i<end;i+=3) {
+        glm::vec3 a = vertices[indices[i+0]].position;
+        glm::vec3 b = vertices[indices[i+1]].position;
+        glm::vec3 c = vertices[indices[i+2]].position;
+        glm::vec3 n = glm::cross(b-a, c-a);
+        if(glm::length(n) == 0.0f)
+            continue;
+        n = glm::normalize(n);
+        normals.push_back(n);
+        axis += n;
+    }
+    if(normals.empty() || glm::length(axis) == 0.0f) {
+        meshlet.cone = glm::vec4(0.0f, 0.0f, 1.0f, 2.0f);
+        return meshlet;
+    }
+    axis = glm::normalize(axis);
+    float mindot = 1.0f;
+    for(size_t i = 0;i<normals.size();++i)
+        mindot = std::min(mindot, glm::dot(axis, normals[i]));
+
+    // if the cone is wider than a hemisphere it can never be culled
+    float cutoff = mindot <= 0.0f ? 2.0f : std::sqrt(1.0f-mindot*mindot);
+    meshlet.cone = glm::vec4(axis, cutoff);
+    return meshlet;
+}
+
+// greedily split the index buffer into meshlets in the existing
+// triangle order
+void build_meshlets(const std::vector<Vertex> &vertices, const std::vector<GLuint> &indices, std::vector<Meshlet> &meshlets) {
+    const size_t max_vertices = 64, max_triangles = 124;
+    std::vector<GLuint> unique;
+    size_t begin = 0;
+    for(size_t i = 0;i<indices.size();i+=3) {
+        size_t added = 0;
+        for(int k = 0;k<3;++k)
+            if(std::find(unique.begin(), unique.end(), indices[i+k]) == unique.end())
+                ++added;
+
+        if(unique.size()+added > max_vertices || (i-begin)/3 == max_triangles) {
+            meshlets.push_back(meshlet_bounds(vertices, indices, begin, i));
+            begin = i;
+            unique.clear();
+        }
+
+        for(int k = 0;k<3;++k)
+            if(std::find(unique.begin(), unique.end(), indices[i+k]) == unique.end())
+                unique.push_back(indices[i+k]);
+    }
+    if(begin != indices.size())
+        meshlets.push_back(meshlet_bounds(vertices, indices, begin, indices.size()));
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "18meshlet_culling", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 430\n"
+        "layout(location = 0) uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 430\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // the culling shader tests one meshlet per invocation and writes
+    // its draw command. The backface test is the conservative cone test
+    // that also accounts for the extent of the meshlet.
+    std::string cull_source =
+        "#version 430\n"
+        "layout(local_size_x=64) in;\n"
+
+        "struct Meshlet { vec4 sphere; vec4 cone; uint indexoffset; uint indexcount; uvec2 padding; };\n"
+        "struct Command { uint count; uint instanceCount; uint firstIndex; uint baseVertex; uint baseInstance; };\n"
+
+        "layout(location = 0) uniform vec4 planes[6];\n"
+        "layout(location = 6) uniform vec3 eye;\n"
+        "layout(location = 7) uniform uint count;\n"
+        "layout(location = 8) uniform bool cull;\n"
+        "layout(std430, binding=0) readonly buffer mblock { Meshlet meshlets[]; };\n"
+        "layout(std430, binding=1) writeonly buffer cblock { Command commands[]; };\n"
+        "layout(std430, binding=2) buffer vblock { uint visible; };\n"
+
+        "void main() {\n"
+        "   uint index = gl_GlobalInvocationID.x;\n"
+        "   if(index >= count) return;\n"
+        "   Meshlet meshlet = meshlets[index];\n"
+        "   bool draw = true;\n"
+        "   if(cull) {\n"
+        "       for(int i = 0;i<6;++i)\n"
+        "           draw = draw && dot(planes[i], vec4(meshlet.sphere.xyz, 1)) > -meshlet.sphere.w;\n"
+        "       vec3 view = meshlet.sphere.xyz-eye;\n"
+        "       draw = draw && dot(view, meshlet.cone.xyz) < meshlet.cone.w*length(view)+meshlet.sphere.w;\n"
+        "   }\n"
+        "   if(draw) atomicAdd(visible, 1);\n"
+        "   commands[index].count = meshlet.indexcount;\n"
+        "   commands[index].instanceCount = draw?1:0;\n"
+        "   commands[index].firstIndex = meshlet.indexoffset;\n"
+        "   commands[index].baseVertex = 0;\n"
+        "   commands[index].baseInstance = 0;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint cull_program, cull_shader;
+
+    // create and compiler compute shader
+    cull_shader = glCreateShader(GL_COMPUTE_SHADER);
+    source = cull_source.c_str();
+    length = cull_source.size();
+    glShaderSource(cull_shader, 1, &source, &length);
+    glCompileShader(cull_shader);
+    if(!check_shader_compile_status(cull_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    cull_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(cull_program, cull_shader);
+
+    // link the program and check for errors
+    glLinkProgram(cull_program);
+    check_program_link_status(cull_program);
+
+    // generate a dense mesh, a grid of 16x16 tori with 8K triangles each
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;
+    const int major = 128, minor = 32;
+    for(int x = 0;x<16;++x) {
+        for(int y = 0;y<16;++y) {
+            GLuint base = vertices.size();
+            glm::vec3 offset(3.0f*x-22.5f, 3.0f*y-22.5f, 0.0f);
+            for(int i = 0;i<major;++i) {
+                float phi = 2.0f*3.1416f*i/major;
+                glm::vec3 center(std::cos(phi), std::sin(phi), 0.0f);
+                for(int j = 0;j<minor;++j) {
+                    float theta = 2.0f*3.1416f*j/minor;
+                    Vertex vertex;
+                    vertex.normal = std::cos(theta)*center + glm::vec3(0.0f, 0.0f, std::sin(theta));
+                    vertex.position = offset + center + 0.4f*vertex.normal;
+                    vertices.push_back(vertex);
+                }
+            }
+            // generate the quads in small 4x4 patches so the meshlets
+            // are compact
+            for(int pi = 0;pi<major;pi+=4) {
+                for(int pj = 0;pj<minor;pj+=4) {
+                    for(int i = pi;i<pi+4;++i) {
+                        for(int j = pj;j<pj+4;++j) {
+                            GLuint a = base + i*minor+j;
+                            GLuint b = base + i*minor+(j+1)%minor;
+                            GLuint c = base + ((i+1)%major)*minor+j;
+                            GLuint d = base + ((i+1)%major)*minor+(j+1)%minor;
+                            indices.push_back(a); indices.push_back(c); indices.push_back(b);
+                            indices.push_back(b); indices.push_back(c); indices.push_back(d);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Meshlet> meshlets;
+    build_meshlets(vertices, indices, meshlets);
+    std::cout << indices.size()/3 << " triangles in " << meshlets.size() << " meshlets" << std::endl;
+    const GLuint meshletcount = meshlets.size();
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex)*vertices.size(), &vertices[0], GL_STATIC_DRAW);
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indices.size(), &indices[0], GL_STATIC_DRAW);
+
+    // meshlet and command buffers
+    GLuint meshlet_ssbo, command_buffer;
+
+    glGenBuffers(1, &meshlet_ssbo);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, meshlet_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(Meshlet)*meshlets.size(), &meshlets[0], GL_STATIC_DRAW);
+
+    glGenBuffers(1, &command_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand)*meshlets.size(), 0, GL_DYNAMIC_COPY);
+
+    // the visible meshlet counters are read back a few frames later
+    // to avoid stalling
+    const int countercount = 3;
+    GLuint counter_buffers[countercount];
+    int current_counter = 0;
+    glGenBuffers(countercount, counter_buffers);
+    for(int i = 0;i<countercount;++i) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter_buffers[i]);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), 0, GL_DYNAMIC_READ);
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, meshlet_ssbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, command_buffer);
+
+    glUseProgram(cull_program);
+    glUniform1ui(7, meshletcount);
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // timer query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    bool cull = true;
+    bool space_down = false;
+    int frame = 0;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle culling
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            cull = !cull;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // fly over the tori while looking around
+        glm::vec3 eye(20.0f*std::sin(0.1f*t), 20.0f*std::cos(0.13f*t), 6.0f);
+        glm::mat4 View = glm::rotate(glm::mat4(1.0f), -50.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, 20.0f*t, glm::vec3(0.0f, 0.0f, 1.0f));
+        View = glm::translate(View, -eye);
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // extract the frustum planes from the rows of the matrix
+        glm::mat4 M = glm::transpose(ViewProjection);
+        glm::vec4 planes[6] = {
+            M[3]+M[0], M[3]-M[0],
+            M[3]+M[1], M[3]-M[1],
+            M[3]+M[2], M[3]-M[2],
+        };
+        for(int i = 0;i<6;++i)
+            planes[i] /= glm::length(glm::vec3(planes[i]));
+
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        // reset the visible counter and run the culling shader
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, counter_buffers[current_counter]);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+
+        glUseProgram(cull_program);
+        glUniform4fv(0, 6, glm::value_ptr(planes[0]));
+        glUniform3fv(6, 1, glm::value_ptr(eye));
+        glUniform1i(8, cull);
+        glDispatchCompute((meshletcount+63)/64, 1, 1);
+
+        // make the commands visible to the indirect draw
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // set the uniform
+        glUniformMatrix4fv(0, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw all meshlets, culled ones have an instance count of zero
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, 0, meshletcount, 0);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+
+            // the oldest counter buffer is from countercount-1 frames ago
+            GLuint visible = 0;
+            if(frame >= countercount) {
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, counter_buffers[(current_counter+1)%countercount]);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &visible);
+            }
+            std::cout << result*1.e-6 << " ms/frame " << visible << "/" << meshletcount << " meshlets visible" << std::endl;
+        }
+        // advance query and counter indices
+        current_query = (current_query + 1)%querycount;
+        current_counter = (current_counter + 1)%countercount;
+        ++frame;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, queries);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+    glDeleteBuffers(1, &meshlet_ssbo);
+    glDeleteBuffers(1, &command_buffer);
+    glDeleteBuffers(countercount, counter_buffers);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(cull_program, cull_shader);
+    glDeleteShader(cull_shader);
+    glDeleteProgram(cull_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
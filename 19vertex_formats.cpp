@@ -0,0 +1,437 @@
+/* OpenGL example code - Vertex Format Benchmark
+ *
+ * Draws a mesh with several million vertices using different vertex
+ * layouts and attribute encodings and measures the vertex throughput
+ * with timer queries. Every encoding is tested with interleaved
+ * attributes and with one stream per attribute (SoA). The encodings are:
+ * float:    everything as 32 bit floats
+ * half:     everything as 16 bit half floats
+ * 2_10_10_10: float positions, GL_INT_2_10_10_10_REV normals,
+ *           GL_UNSIGNED_INT_2_10_10_10_REV colors, half texcoords
+ * normalized: normalized shorts for positions and texcoords and
+ *           normalized bytes for normals and colors
+ *
+ * The vertices are drawn as points so the fragment work stays small.
+ * The example cycles through all layouts and prints a summary at the
+ * end.
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cmath>
+
+// encoding of a single attribute
+struct AttributeFormat {
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    GLsizei bytes;
+};
+
+// the four attributes are position, normal, color and texcoord
+const int attributecount = 4;
+const int encodingcount = 4;
+const AttributeFormat encodings[encodingcount][attributecount] = {
+    // float
+    {{3, GL_FLOAT, GL_FALSE, 12}, {3, GL_FLOAT, GL_FALSE, 12}, {4, GL_FLOAT, GL_FALSE, 16}, {2, GL_FLOAT, GL_FALSE, 8}},
+    // half, three component attributes are padded to four
+    {{4, GL_HALF_FLOAT, GL_FALSE, 8}, {4, GL_HALF_FLOAT, GL_FALSE, 8}, {4, GL_HALF_FLOAT, GL_FALSE, 8}, {2, GL_HALF_FLOAT, GL_FALSE, 4}},
+    // 2_10_10_10
+    {{3, GL_FLOAT, GL_FALSE, 12}, {4, GL_INT_2_10_10_10_REV, GL_TRUE, 4}, {4, GL_UNSIGNED_INT_2_10_10_10_REV, GL_TRUE, 4}, {2, GL_HALF_FLOAT, GL_FALSE, 4}},
+    // normalized integers
+    {{4, GL_SHORT, GL_TRUE, 8}, {4, GL_BYTE, GL_TRUE, 4}, {4, GL_UNSIGNED_BYTE, GL_TRUE, 4}, {2, GL_UNSIGNED_SHORT, GL_TRUE, 4}},
+};
+const char *encoding_names[encodingcount] = {"float", "half", "2_10_10_10", "normalized"};
+
+// convert a float to a half float, rounds towards zero
+GLushort float_to_half(float value) {
+    GLuint bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    GLuint sign = (bits >> 16) & 0x8000;
+    int exponent = int((bits >> 23) & 0xff) - 127 + 15;
+    GLuint mantissa = bits & 0x7fffff;
+    if(exponent <= 0) {
+        // denormals and zero
+        if(exponent < -10)
+            return sign;
+        mantissa |= 0x800000;
+        return sign | (mantissa >> (14 - exponent));
+    }
+    if(exponent >= 31)
+        return sign | 0x7c00;
+    return sign | (exponent << 10) | (mantissa >> 13);
+}
+
+// pack four components in [-1,1] (or [0,1] if unsigned) into 2_10_10_10
+GLuint pack_2_10_10_10(const float *v, bool is_signed) {
+    GLuint packed = 0;
+    for(int i = 0;i<4;++i) {
+        int bits = i<3 ? 10 : 2;
+        int max = is_signed ? (1<<(bits-1))-1 : (1<<bits)-1;
+        int value = int(std::floor(v[i]*max+0.5f));
+        packed |= (GLuint(value) & ((1u<<bits)-1)) << (10*i);
+    }
+    return packed;
+}
+
+// write value with the given encoding
+void encode_attribute(const AttributeFormat &format, const float *value, char *out) {
+    for(int i = 0;i<format.components;++i) {
+        switch(format.type) {
+        case GL_FLOAT:
+            std::memcpy(out+4*i, value+i, 4);
+            break;
+        case GL_HALF_FLOAT: {
+            GLushort half = float_to_half(value[i]);
+            std::memcpy(out+2*i, &half, 2);
+            break; }
+        case GL_SHORT: {
+            GLshort s = GLshort(std::floor(value[i]*32767.0f+0.5f));
+            std::memcpy(out+2*i, &s, 2);
+            break; }
+        case GL_UNSIGNED_SHORT: {
+            GLushort s = GLushort(std::floor(value[i]*65535.0f+0.5f));
+            std::memcpy(out+2*i, &s, 2);
+            break; }
+        case GL_BYTE:
+            out[i] = GLbyte(std::floor(value[i]*127.0f+0.5f));
+            break;
+        case GL_UNSIGNED_BYTE:
+            out[i] = char(GLubyte(std::floor(value[i]*255.0f+0.5f)));
+            break;
+        }
+    }
+    if(format.type == GL_INT_2_10_10_10_REV || format.type == GL_UNSIGNED_INT_2_10_10_10_REV) {
+        GLuint packed = pack_2_10_10_10(value, format.type == GL_INT_2_10_10_10_REV);
+        std::memcpy(out, &packed, 4);
+    }
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "19vertex_formats", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    // all attributes contribute to the output so none of them
+    // can be optimized away
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 vnormal;\n"
+        "layout(location = 2) in vec4 vcolor;\n"
+        "layout(location = 3) in vec2 vtexcoord;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = 0.3+0.7*max(0, dot(vnormal, normalize(vec3(1,2,3))));\n"
+        "   fcolor = brightness*vcolor*(0.8+0.2*fract(16*vtexcoord.x));\n"
+        "   gl_Position = ViewProjection*vec4(vposition.xyz, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+
+    // generate a sphere with 2048x2048 vertices, all attributes are in
+    // [-1,1] or [0,1] so they fit the normalized encodings
+    const int grid = 2048;
+    const int vertexcount = grid*grid;
+    std::vector<float> attributes[attributecount];
+    for(int a = 0;a<attributecount;++a)
+        attributes[a].resize(4*vertexcount);
+    for(int i = 0;i<grid;++i) {
+        float theta = 3.1416f*(i+0.5f)/grid;
+        for(int j = 0;j<grid;++j) {
+            float phi = 2.0f*3.1416f*j/grid;
+            int v = 4*(i*grid+j);
+            glm::vec3 normal(std::sin(theta)*std::cos(phi), std::cos(theta), std::sin(theta)*std::sin(phi));
+            float *position = &attributes[0][v];
+            position[0] = 0.9f*normal.x; position[1] = 0.9f*normal.y; position[2] = 0.9f*normal.z; position[3] = 1.0f;
+            float *n = &attributes[1][v];
+            n[0] = normal.x; n[1] = normal.y; n[2] = normal.z; n[3] = 0.0f;
+            float *color = &attributes[2][v];
+            color[0] = 0.5f+0.5f*normal.x; color[1] = 0.5f+0.5f*normal.y; color[2] = 0.5f+0.5f*normal.z; color[3] = 1.0f;
+            float *texcoord = &attributes[3][v];
+            texcoord[0] = float(j)/grid; texcoord[1] = float(i)/grid; texcoord[2] = 0.0f; texcoord[3] = 0.0f;
+        }
+    }
+
+    // vao and vbo handle, they are recreated for every layout
+    GLuint vao = 0, vbo = 0;
+
+    // measurement parameters
+    const int warmup = 10;
+    const int measured = 50;
+    const int drawsperframe = 4;
+    const int layoutcount = 2*encodingcount;
+
+    std::vector<GLuint> queries(measured);
+    glGenQueries(measured, &queries[0]);
+    std::vector<double> results(layoutcount);
+    std::vector<int> vertexsizes(layoutcount);
+
+    glEnable(GL_DEPTH_TEST);
+
+    int layout = -1;
+    int frame = 0;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // collect the results of the current layout and advance to the next
+        if(layout < 0 || frame == warmup+measured) {
+            if(layout >= 0) {
+                GLuint64 total = 0;
+                for(int i = 0;i<measured;++i) {
+                    GLuint64 result;
+                    glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &result);
+                    total += result;
+                }
+                results[layout] = total*1.e-6/measured;
+                std::cout << (layout%2?"soa         ":"interleaved ") << encoding_names[layout/2] << ": "
+                          << results[layout] << " ms/frame" << std::endl;
+            }
+
+            ++layout;
+            frame = 0;
+            if(layout == layoutcount)
+                break;
+
+            glDeleteVertexArrays(1, &vao);
+            glDeleteBuffers(1, &vbo);
+
+            const AttributeFormat *format = encodings[layout/2];
+            bool interleaved = layout%2 == 0;
+            GLsizei stride = 0;
+            for(int a = 0;a<attributecount;++a)
+                stride += format[a].bytes;
+            vertexsizes[layout] = stride;
+
+            // encode the vertex data, interleaved layouts have one stream
+            // with all attributes and SoA layouts one stream per attribute
+            std::vector<char> data(size_t(stride)*vertexcount);
+            size_t offsets[attributecount];
+            size_t offset = 0;
+            for(int a = 0;a<attributecount;++a) {
+                offsets[a] = offset;
+                offset += interleaved ? format[a].bytes : size_t(format[a].bytes)*vertexcount;
+            }
+            for(int v = 0;v<vertexcount;++v) {
+                for(int a = 0;a<attributecount;++a) {
+                    size_t position = interleaved ? size_t(stride)*v + offsets[a] : offsets[a] + size_t(format[a].bytes)*v;
+                    encode_attribute(format[a], &attributes[a][4*v], &data[position]);
+                }
+            }
+
+            // generate and bind the vao
+            glGenVertexArrays(1, &vao);
+            glBindVertexArray(vao);
+
+            // generate and bind the vertex buffer object
+            glGenBuffers(1, &vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+            // fill with data
+            glBufferData(GL_ARRAY_BUFFER, data.size(), &data[0], GL_STATIC_DRAW);
+
+            // set up generic attrib pointers
+            for(int a = 0;a<attributecount;++a) {
+                glEnableVertexAttribArray(a);
+                glVertexAttribPointer(a, format[a].components, format[a].type, format[a].normalized,
+                                      interleaved ? stride : format[a].bytes, (char*)0 + offsets[a]);
+            }
+        }
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw, only the frames after the warmup are measured
+        if(frame >= warmup)
+            glBeginQuery(GL_TIME_ELAPSED, queries[frame-warmup]);
+        for(int i = 0;i<drawsperframe;++i)
+            glDrawArrays(GL_POINTS, 0, vertexcount);
+        if(frame >= warmup)
+            glEndQuery(GL_TIME_ELAPSED);
+        ++frame;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // print the summary
+    if(layout == layoutcount) {
+        std::cout << std::endl << "layout       encoding    bytes/vertex  ms/frame  Mvertices/s  GB/s" << std::endl;
+        for(int i = 0;i<layoutcount;++i) {
+            double vertices = double(drawsperframe)*vertexcount;
+            std::cout << (i%2?"soa          ":"interleaved  ") << encoding_names[i/2] << "\t"
+                      << vertexsizes[i] << "\t" << results[i] << "\t"
+                      << vertices/results[i]*1.e-3 << "\t"
+                      << vertices*vertexsizes[i]/results[i]*1.e-6 << std::endl;
+        }
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(measured, &queries[0]);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
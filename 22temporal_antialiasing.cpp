@@ -0,0 +1,666 @@
+/* OpenGL example code - temporal antialiasing
+ *
+ * render a grid of cubes to a texture with a sub-pixel jitter that
+ * changes every frame and accumulate the frames in a history buffer.
+ * The history is reprojected into the current frame by reconstructing
+ * the position from the depth buffer and transforming it with the
+ * previous frame's view projection matrix. To avoid ghosting the
+ * history is clamped to the color range of the current frame's 3x3
+ * neighbourhood.
+ * Since the jitter covers different sub-pixel positions the history
+ * can also be used to upsample from a reduced internal resolution
+ * which reduces the shading rate.
+ *
+ * toggle taa on/off with space
+ * select the internal resolution (100%, 75%, 50%) with 1-3
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// element of the halton low discrepancy sequence, used to generate
+// the jitter offsets
+float halton(int index, int base) {
+    float result = 0.0f;
+    float f = 1.0f;
+    while(index > 0) {
+        f /= base;
+        result += f*(index%base);
+        index /= base;
+    }
+    return result;
+}
+
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "22temporal_antialiasing", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n" // the projection matrix uniform
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   fcolor = vcolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    // "unbind" vao
+    glBindVertexArray(0);
+
+    // shader source code
+    std::string post_effect_vertex_source =
+        "#version 330\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec2 vtexcoord;\n"
+        "out vec2 ftexcoord;\n"
+        "void main() {\n"
+        "   ftexcoord = vtexcoord;\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    // the resolve pass runs at the output resolution. The current frame
+    // covers the region uvscale of the scene textures and is shifted by
+    // the jitter (in internal pixels), so it is sampled at the unjittered
+    // position.
+    std::string post_effect_fragment_source =
+        "#version 330\n"
+        "uniform sampler2D color;\n"
+        "uniform sampler2D depth;\n"
+        "uniform sampler2D history;\n"
+        "uniform mat4 Reprojection;\n"
+        "uniform vec2 uvscale;\n"
+        "uniform vec2 jitter;\n"
+        "uniform float alpha;\n"
+        "in vec2 ftexcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   vec2 texelsize = 1.0/textureSize(color, 0);\n"
+        "   vec2 uv = uvscale*ftexcoord + jitter*texelsize;\n"
+        "   vec4 current = textureLod(color, uv, 0.0);\n"
+
+        // color range of the neighbourhood in the current frame
+        "   vec4 cmin = current;\n"
+        "   vec4 cmax = current;\n"
+        "   for(int y = -1;y<=1;++y) {\n"
+        "       for(int x = -1;x<=1;++x) {\n"
+        "           vec4 neighbour = textureLod(color, uv + vec2(x,y)*texelsize, 0.0);\n"
+        "           cmin = min(cmin, neighbour);\n"
+        "           cmax = max(cmax, neighbour);\n"
+        "       }\n"
+        "   }\n"
+
+        // reproject into the previous frame using the depth buffer
+        "   float z = textureLod(depth, uv, 0.0).x;\n"
+        "   vec4 previous = Reprojection*vec4(2.0*ftexcoord-1.0, 2.0*z-1.0, 1.0);\n"
+        "   vec2 historyuv = 0.5*previous.xy/previous.w+0.5;\n"
+
+        // discard history that falls outside of the previous frame
+        "   float weight = alpha;\n"
+        "   if(any(lessThan(historyuv, vec2(0.0))) || any(greaterThan(historyuv, vec2(1.0))))\n"
+        "       weight = 1.0;\n"
+        "   vec4 last = clamp(textureLod(history, historyuv, 0.0), cmin, cmax);\n"
+        "   FragColor = mix(last, current, weight);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint post_effect_shader_program, post_effect_vertex_shader, post_effect_fragment_shader;
+
+    // create and compiler vertex shader
+    post_effect_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = post_effect_vertex_source.c_str();
+    length = post_effect_vertex_source.size();
+    glShaderSource(post_effect_vertex_shader, 1, &source, &length);
+    glCompileShader(post_effect_vertex_shader);
+    if(!check_shader_compile_status(post_effect_vertex_shader))
+    {
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    post_effect_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = post_effect_fragment_source.c_str();
+    length = post_effect_fragment_source.size();
+    glShaderSource(post_effect_fragment_shader, 1, &source, &length);
+    glCompileShader(post_effect_fragment_shader);
+    if(!check_shader_compile_status(post_effect_fragment_shader))
+    {
+        return 1;
+    }
+
+    // create program
+    post_effect_shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(post_effect_shader_program, post_effect_vertex_shader);
+    glAttachShader(post_effect_shader_program, post_effect_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(post_effect_shader_program);
+    check_program_link_status(post_effect_shader_program);
+
+    // get uniform locations
+    GLint post_effect_color_location = glGetUniformLocation(post_effect_shader_program, "color");
+    GLint post_effect_depth_location = glGetUniformLocation(post_effect_shader_program, "depth");
+    GLint post_effect_history_location = glGetUniformLocation(post_effect_shader_program, "history");
+    GLint post_effect_Reprojection_location = glGetUniformLocation(post_effect_shader_program, "Reprojection");
+    GLint post_effect_uvscale_location = glGetUniformLocation(post_effect_shader_program, "uvscale");
+    GLint post_effect_jitter_location = glGetUniformLocation(post_effect_shader_program, "jitter");
+    GLint post_effect_alpha_location = glGetUniformLocation(post_effect_shader_program, "alpha");
+
+    // vao and vbo handle
+    GLuint post_effect_vao, post_effect_vbo, post_effect_ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &post_effect_vao);
+    glBindVertexArray(post_effect_vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &post_effect_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, post_effect_vbo);
+
+    // data for a fullscreen quad (this time with texture coords)
+    GLfloat post_effect_vertexData[] = {
+    //  X     Y     Z           U     V
+       1.0f, 1.0f, 0.0f,       1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f, 0.0f,       0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f, 0.0f,       1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 0.0f,       0.0f, 0.0f, // vertex 3
+    }; // 4 vertices with 5 components (floats) each
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*4*5, post_effect_vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &post_effect_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, post_effect_ibo);
+
+    GLuint post_effect_indexData[] = {
+        0,1,2, // first triangle
+        2,1,3, // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*2*3, post_effect_indexData, GL_STATIC_DRAW);
+
+    // "unbind" vao
+    glBindVertexArray(0);
+
+    // scene color, scene depth and two history textures
+    // the history is ping ponged between frames
+    GLuint color_texture, depth_texture, history_texture[2];
+
+    glGenTextures(1, &color_texture);
+    glBindTexture(GL_TEXTURE_2D, color_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    // the depth is read back in the resolve pass so it has to be a texture
+    glGenTextures(1, &depth_texture);
+    glBindTexture(GL_TEXTURE_2D, depth_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, width, height, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+
+    // the history has more precision to reduce banding from the
+    // repeated blending
+    glGenTextures(2, history_texture);
+    for(int i = 0;i<2;++i) {
+        glBindTexture(GL_TEXTURE_2D, history_texture[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, 0);
+    }
+
+    // framebuffer handles
+    GLuint scene_fbo, history_fbo[2];
+
+    glGenFramebuffers(1, &scene_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, scene_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_texture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth_texture, 0);
+
+    glGenFramebuffers(2, history_fbo);
+    for(int i = 0;i<2;++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, history_fbo[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, history_texture[i], 0);
+
+        // clear so the first frame doesn't blend with undefined content
+        glClear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // timer query setup, one query for each pass
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint scene_queries[querycount], resolve_queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, scene_queries);
+    glGenQueries(querycount, resolve_queries);
+
+    // length of the jitter sequence
+    const int jittercount = 8;
+
+    const float scales[3] = {1.0f, 0.75f, 0.5f};
+    float scale = 1.0f;
+
+    glm::mat4 PreviousViewProjection;
+    bool reset = true;
+    int current_history = 0;
+    int frame = 0;
+
+    bool taa = true;
+    bool space_down = false;
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle taa on/off with space
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down)
+        {
+            taa = !taa;
+            reset = true;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // select the internal resolution
+        for(int i = 0;i<3;++i) {
+            if(glfwGetKey(window, GLFW_KEY_1+i) && scale != scales[i]) {
+                scale = scales[i];
+                reset = true;
+            }
+        }
+
+        int scaled_width = int(scale*width);
+        int scaled_height = int(scale*height);
+
+        // jitter in internal pixels in the range [-0.5, 0.5]
+        glm::vec2 jitter(0.0f, 0.0f);
+        if(taa)
+            jitter = glm::vec2(halton(frame%jittercount+1, 2)-0.5f, halton(frame%jittercount+1, 3)-0.5f);
+
+        glBeginQuery(GL_TIME_ELAPSED, scene_queries[current_query]);
+
+        glEnable(GL_DEPTH_TEST);
+
+        // bind target framebuffer and only render to the scaled region
+        glBindFramebuffer(GL_FRAMEBUFFER, scene_fbo);
+        glViewport(0, 0, scaled_width, scaled_height);
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*t, glm::vec3(1.0f, 1.0f, 1.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // the jitter is applied as a translation in clip space
+        glm::mat4 Jitter = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f*jitter.x/scaled_width, 2.0f*jitter.y/scaled_height, 0.0f));
+        glm::mat4 JitteredViewProjection = Jitter*ViewProjection;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(JitteredViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, 8*8*8);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        glBeginQuery(GL_TIME_ELAPSED, resolve_queries[current_query]);
+
+        // resolve into the next history buffer at full resolution
+        glBindFramebuffer(GL_FRAMEBUFFER, history_fbo[1-current_history]);
+        glViewport(0, 0, width, height);
+
+        // we are not 3d rendering so no depth test
+        glDisable(GL_DEPTH_TEST);
+
+        // use the shader program
+        glUseProgram(post_effect_shader_program);
+
+        // bind textures
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, color_texture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, depth_texture);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, history_texture[current_history]);
+
+        // the reprojection uses the unjittered matrices since the
+        // depth is sampled at the unjittered position
+        glm::mat4 Reprojection = PreviousViewProjection*glm::inverse(ViewProjection);
+
+        // set uniforms
+        glUniform1i(post_effect_color_location, 0);
+        glUniform1i(post_effect_depth_location, 1);
+        glUniform1i(post_effect_history_location, 2);
+        glUniformMatrix4fv(post_effect_Reprojection_location, 1, GL_FALSE, glm::value_ptr(Reprojection));
+        glUniform2f(post_effect_uvscale_location, float(scaled_width)/width, float(scaled_height)/height);
+        glUniform2f(post_effect_jitter_location, jitter.x, jitter.y);
+
+        // without taa or valid history the current frame is just upsampled
+        glUniform1f(post_effect_alpha_location, (taa && !reset)?0.1f:1.0f);
+
+        // bind the vao
+        glBindVertexArray(post_effect_vao);
+
+        // draw
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        // copy the result to the window
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, history_fbo[1-current_history]);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        PreviousViewProjection = ViewProjection;
+        current_history = 1-current_history;
+        reset = false;
+        ++frame;
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(scene_queries[(current_query+1)%querycount])) {
+            GLuint64 scene_result, resolve_result;
+            glGetQueryObjectui64v(scene_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &scene_result);
+            glGetQueryObjectui64v(resolve_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &resolve_result);
+            std::cout << scene_result*1.e-6 << " ms scene " << resolve_result*1.e-6 << " ms resolve" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, scene_queries);
+    glDeleteQueries(querycount, resolve_queries);
+
+    glDeleteFramebuffers(1, &scene_fbo);
+    glDeleteFramebuffers(2, history_fbo);
+    glDeleteTextures(1, &color_texture);
+    glDeleteTextures(1, &depth_texture);
+    glDeleteTextures(2, history_texture);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDeleteVertexArrays(1, &post_effect_vao);
+    glDeleteBuffers(1, &post_effect_vbo);
+    glDeleteBuffers(1, &post_effect_ibo);
+
+    glDetachShader(post_effect_shader_program, post_effect_vertex_shader);
+    glDetachShader(post_effect_shader_program, post_effect_fragment_shader);
+    glDeleteShader(post_effect_vertex_shader);
+    glDeleteShader(post_effect_fragment_shader);
+    glDeleteProgram(post_effect_shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
@@ -0,0 +1,978 @@
+/* OpenGL example code - hdr & auto exposure
+ *
+ * render a grid of cubes with a high dynamic range of intensities to a
+ * GL_R11F_G11F_B10F texture. This packed float format has the same
+ * size as GL_RGBA8 so the HDR target costs about the same bandwidth
+ * as the LDR one. A compute shader builds a histogram of the log
+ * luminance and a second compute shader reduces it to the average
+ * luminance and adapts the exposure over time. The result stays in a
+ * buffer and is read by the tonemapping pass directly, so there is no
+ * readback to the CPU. The tonemapping pass also writes the luma to
+ * alpha so the fxaa pass from the fbo & fxaa example can follow
+ * without an extra pass.
+ *
+ * toggle auto exposure with space
+ * select GL_R11F_G11F_B10F or GL_RGBA16F as HDR format with 1/2
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cmath>
+
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "23hdr_auto_exposure", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n" // the projection matrix uniform
+        "uniform float intensity;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        // every instance has a different brightness spanning several
+        // orders of magnitude
+        "   fcolor = intensity*exp2(float(gl_InstanceID%13)-6.0)*vcolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint intensity_location = glGetUniformLocation(shader_program, "intensity");
+
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    // "unbind" vao
+    glBindVertexArray(0);
+
+    // shader source code
+    std::string post_effect_vertex_source =
+        "#version 330\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec2 vtexcoord;\n"
+        "out vec2 ftexcoord;\n"
+        "void main() {\n"
+        "   ftexcoord = vtexcoord;\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    // this is a Timothy Lottes FXAA 3.11
+    // check out the following link for detailed information:
+    // http://timothylottes.blogspot.ch/2011/07/fxaa-311-released.html
+    //
+    // the shader source has been stripped with a preprocessor for
+    // brevity reasons (it's still pretty long for inlining...).
+    // the used defines are:
+    // #define FXAA_PC 1
+    // #define FXAA_GLSL_130 1
+    // #define FXAA_QUALITY__PRESET 13
+
+    std::string post_effect_fragment_source =
+        "#version 330\n"
+        "uniform sampler2D intexture;\n"
+        "in vec2 ftexcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "\n"
+        "float FxaaLuma(vec4 rgba) {\n"
+        "    return rgba.w;\n"
+        "}\n"
+        "\n"
+        "vec4 FxaaPixelShader(\n"
+        "    vec2 pos,\n"
+        "    sampler2D tex,\n"
+        "    vec2 fxaaQualityRcpFrame,\n"
+        "    float fxaaQualitySubpix,\n"
+        "    float fxaaQualityEdgeThreshold,\n"
+        "    float fxaaQualityEdgeThresholdMin\n"
+        ") {\n"
+        "    vec2 posM;\n"
+        "    posM.x = pos.x;\n"
+        "    posM.y = pos.y;\n"
+        "    vec4 rgbyM = textureLod(tex, posM, 0.0);\n"
+        "    float lumaS = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2( 0, 1)));\n"
+        "    float lumaE = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2( 1, 0)));\n"
+        "    float lumaN = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2( 0,-1)));\n"
+        "    float lumaW = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2(-1, 0)));\n"
+        "    float maxSM = max(lumaS, rgbyM.w);\n"
+        "    float minSM = min(lumaS, rgbyM.w);\n"
+        "    float maxESM = max(lumaE, maxSM);\n"
+        "    float minESM = min(lumaE, minSM);\n"
+        "    float maxWN = max(lumaN, lumaW);\n"
+        "    float minWN = min(lumaN, lumaW);\n"
+        "    float rangeMax = max(maxWN, maxESM);\n"
+        "    float rangeMin = min(minWN, minESM);\n"
+        "    float rangeMaxScaled = rangeMax * fxaaQualityEdgeThreshold;\n"
+        "    float range = rangeMax - rangeMin;\n"
+        "    float rangeMaxClamped = max(fxaaQualityEdgeThresholdMin, rangeMaxScaled);\n"
+        "    bool earlyExit = range < rangeMaxClamped;\n"
+        "    if(earlyExit)\n"
+        "        return rgbyM;\n"
+        "\n"
+        "    float lumaNW = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2(-1,-1)));\n"
+        "    float lumaSE = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2( 1, 1)));\n"
+        "    float lumaNE = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2( 1,-1)));\n"
+        "    float lumaSW = FxaaLuma(textureLodOffset(tex, posM, 0.0, ivec2(-1, 1)));\n"
+        "    float lumaNS = lumaN + lumaS;\n"
+        "    float lumaWE = lumaW + lumaE;\n"
+        "    float subpixRcpRange = 1.0/range;\n"
+        "    float subpixNSWE = lumaNS + lumaWE;\n"
+        "    float edgeHorz1 = (-2.0 * rgbyM.w) + lumaNS;\n"
+        "    float edgeVert1 = (-2.0 * rgbyM.w) + lumaWE;\n"
+        "    float lumaNESE = lumaNE + lumaSE;\n"
+        "    float lumaNWNE = lumaNW + lumaNE;\n"
+        "    float edgeHorz2 = (-2.0 * lumaE) + lumaNESE;\n"
+        "    float edgeVert2 = (-2.0 * lumaN) + lumaNWNE;\n"
+        "    float lumaNWSW = lumaNW + lumaSW;\n"
+        "    float lumaSWSE = lumaSW + lumaSE;\n"
+        "    float edgeHorz4 = (abs(edgeHorz1) * 2.0) + abs(edgeHorz2);\n"
+        "    float edgeVert4 = (abs(edgeVert1) * 2.0) + abs(edgeVert2);\n"
+        "    float edgeHorz3 = (-2.0 * lumaW) + lumaNWSW;\n"
+        "    float edgeVert3 = (-2.0 * lumaS) + lumaSWSE;\n"
+        "    float edgeHorz = abs(edgeHorz3) + edgeHorz4;\n"
+        "    float edgeVert = abs(edgeVert3) + edgeVert4;\n"
+        "    float subpixNWSWNESE = lumaNWSW + lumaNESE;\n"
+        "    float lengthSign = fxaaQualityRcpFrame.x;\n"
+        "    bool horzSpan = edgeHorz >= edgeVert;\n"
+        "    float subpixA = subpixNSWE * 2.0 + subpixNWSWNESE;\n"
+        "    if(!horzSpan) lumaN = lumaW;\n"
+        "    if(!horzSpan) lumaS = lumaE;\n"
+        "    if(horzSpan) lengthSign = fxaaQualityRcpFrame.y;\n"
+        "    float subpixB = (subpixA * (1.0/12.0)) - rgbyM.w;\n"
+        "    float gradientN = lumaN - rgbyM.w;\n"
+        "    float gradientS = lumaS - rgbyM.w;\n"
+        "    float lumaNN = lumaN + rgbyM.w;\n"
+        "    float lumaSS = lumaS + rgbyM.w;\n"
+        "    bool pairN = abs(gradientN) >= abs(gradientS);\n"
+        "    float gradient = max(abs(gradientN), abs(gradientS));\n"
+        "    if(pairN) lengthSign = -lengthSign;\n"
+        "    float subpixC = clamp(abs(subpixB) * subpixRcpRange, 0.0, 1.0);\n"
+        "    vec2 posB;\n"
+        "    posB.x = posM.x;\n"
+        "    posB.y = posM.y;\n"
+        "    vec2 offNP;\n"
+        "    offNP.x = (!horzSpan) ? 0.0 : fxaaQualityRcpFrame.x;\n"
+        "    offNP.y = ( horzSpan) ? 0.0 : fxaaQualityRcpFrame.y;\n"
+        "    if(!horzSpan) posB.x += lengthSign * 0.5;\n"
+        "    if( horzSpan) posB.y += lengthSign * 0.5;\n"
+        "    vec2 posN;\n"
+        "    posN.x = posB.x - offNP.x * 1.0;\n"
+        "    posN.y = posB.y - offNP.y * 1.0;\n"
+        "    vec2 posP;\n"
+        "    posP.x = posB.x + offNP.x * 1.0;\n"
+        "    posP.y = posB.y + offNP.y * 1.0;\n"
+        "    float subpixD = ((-2.0)*subpixC) + 3.0;\n"
+        "    float lumaEndN = FxaaLuma(textureLod(tex, posN, 0.0));\n"
+        "    float subpixE = subpixC * subpixC;\n"
+        "    float lumaEndP = FxaaLuma(textureLod(tex, posP, 0.0));\n"
+        "    if(!pairN) lumaNN = lumaSS;\n"
+        "    float gradientScaled = gradient * 1.0/4.0;\n"
+        "    float lumaMM = rgbyM.w - lumaNN * 0.5;\n"
+        "    float subpixF = subpixD * subpixE;\n"
+        "    bool lumaMLTZero = lumaMM < 0.0;\n"
+        "    lumaEndN -= lumaNN * 0.5;\n"
+        "    lumaEndP -= lumaNN * 0.5;\n"
+        "    bool doneN = abs(lumaEndN) >= gradientScaled;\n"
+        "    bool doneP = abs(lumaEndP) >= gradientScaled;\n"
+        "    if(!doneN) posN.x -= offNP.x * 1.5;\n"
+        "    if(!doneN) posN.y -= offNP.y * 1.5;\n"
+        "    bool doneNP = (!doneN) || (!doneP);\n"
+        "    if(!doneP) posP.x += offNP.x * 1.5;\n"
+        "    if(!doneP) posP.y += offNP.y * 1.5;\n"
+        "    if(doneNP) {\n"
+        "        if(!doneN) lumaEndN = FxaaLuma(textureLod(tex, posN.xy, 0.0));\n"
+        "        if(!doneP) lumaEndP = FxaaLuma(textureLod(tex, posP.xy, 0.0));\n"
+        "        if(!doneN) lumaEndN = lumaEndN - lumaNN * 0.5;\n"
+        "        if(!doneP) lumaEndP = lumaEndP - lumaNN * 0.5;\n"
+        "        doneN = abs(lumaEndN) >= gradientScaled;\n"
+        "        doneP = abs(lumaEndP) >= gradientScaled;\n"
+        "        if(!doneN) posN.x -= offNP.x * 2.0;\n"
+        "        if(!doneN) posN.y -= offNP.y * 2.0;\n"
+        "        doneNP = (!doneN) || (!doneP);\n"
+        "        if(!doneP) posP.x += offNP.x * 2.0;\n"
+        "        if(!doneP) posP.y += offNP.y * 2.0;\n"
+        "        if(doneNP) {\n"
+        "            if(!doneN) lumaEndN = FxaaLuma(textureLod(tex, posN.xy, 0.0));\n"
+        "            if(!doneP) lumaEndP = FxaaLuma(textureLod(tex, posP.xy, 0.0));\n"
+        "            if(!doneN) lumaEndN = lumaEndN - lumaNN * 0.5;\n"
+        "            if(!doneP) lumaEndP = lumaEndP - lumaNN * 0.5;\n"
+        "            doneN = abs(lumaEndN) >= gradientScaled;\n"
+        "            doneP = abs(lumaEndP) >= gradientScaled;\n"
+        "            if(!doneN) posN.x -= offNP.x * 2.0;\n"
+        "            if(!doneN) posN.y -= offNP.y * 2.0;\n"
+        "            doneNP = (!doneN) || (!doneP);\n"
+        "            if(!doneP) posP.x += offNP.x * 2.0;\n"
+        "            if(!doneP) posP.y += offNP.y * 2.0;\n"
+        "            if(doneNP) {\n"
+        "                if(!doneN) lumaEndN = FxaaLuma(textureLod(tex, posN.xy, 0.0));\n"
+        "                if(!doneP) lumaEndP = FxaaLuma(textureLod(tex, posP.xy, 0.0));\n"
+        "                if(!doneN) lumaEndN = lumaEndN - lumaNN * 0.5;\n"
+        "                if(!doneP) lumaEndP = lumaEndP - lumaNN * 0.5;\n"
+        "                doneN = abs(lumaEndN) >= gradientScaled;\n"
+        "                doneP = abs(lumaEndP) >= gradientScaled;\n"
+        "                if(!doneN) posN.x -= offNP.x * 4.0;\n"
+        "                if(!doneN) posN.y -= offNP.y * 4.0;\n"
+        "                doneNP = (!doneN) || (!doneP);\n"
+        "                if(!doneP) posP.x += offNP.x * 4.0;\n"
+        "                if(!doneP) posP.y += offNP.y * 4.0;\n"
+        "                if(doneNP) {\n"
+        "                    if(!doneN) lumaEndN = FxaaLuma(textureLod(tex, posN.xy, 0.0));\n"
+        "                    if(!doneP) lumaEndP = FxaaLuma(textureLod(tex, posP.xy, 0.0));\n"
+        "                    if(!doneN) lumaEndN = lumaEndN - lumaNN * 0.5;\n"
+        "                    if(!doneP) lumaEndP = lumaEndP - lumaNN * 0.5;\n"
+        "                    doneN = abs(lumaEndN) >= gradientScaled;\n"
+        "                    doneP = abs(lumaEndP) >= gradientScaled;\n"
+        "                    if(!doneN) posN.x -= offNP.x * 12.0;\n"
+        "                    if(!doneN) posN.y -= offNP.y * 12.0;\n"
+        "                    doneNP = (!doneN) || (!doneP);\n"
+        "                    if(!doneP) posP.x += offNP.x * 12.0;\n"
+        "                    if(!doneP) posP.y += offNP.y * 12.0;\n"
+        "                }\n"
+        "            }\n"
+        "        }\n"
+        "    }\n"
+        "\n"
+        "    float dstN = posM.x - posN.x;\n"
+        "    float dstP = posP.x - posM.x;\n"
+        "    if(!horzSpan) dstN = posM.y - posN.y;\n"
+        "    if(!horzSpan) dstP = posP.y - posM.y;\n"
+        "\n"
+        "    bool goodSpanN = (lumaEndN < 0.0) != lumaMLTZero;\n"
+        "    float spanLength = (dstP + dstN);\n"
+        "    bool goodSpanP = (lumaEndP < 0.0) != lumaMLTZero;\n"
+        "    float spanLengthRcp = 1.0/spanLength;\n"
+        "\n"
+        "    bool directionN = dstN < dstP;\n"
+        "    float dst = min(dstN, dstP);\n"
+        "    bool goodSpan = directionN ? goodSpanN : goodSpanP;\n"
+        "    float subpixG = subpixF * subpixF;\n"
+        "    float pixelOffset = (dst * (-spanLengthRcp)) + 0.5;\n"
+        "    float subpixH = subpixG * fxaaQualitySubpix;\n"
+        "\n"
+        "    float pixelOffsetGood = goodSpan ? pixelOffset : 0.0;\n"
+        "    float pixelOffsetSubpix = max(pixelOffsetGood, subpixH);\n"
+        "    if(!horzSpan) posM.x += pixelOffsetSubpix * lengthSign;\n"
+        "    if( horzSpan) posM.y += pixelOffsetSubpix * lengthSign;\n"
+        "    \n"
+        "    return vec4(textureLod(tex, posM, 0.0).xyz, rgbyM.w);\n"
+        "}\n"
+        "\n"
+        "void main() {    \n"
+        "    FragColor = FxaaPixelShader(\n"
+        "                    ftexcoord,\n"
+        "                    intexture,\n"
+        "                    1.0/textureSize(intexture,0),\n"
+        "                    0.75,\n"
+        "                    0.166,\n"
+        "                    0.0625\n"
+        "                );\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint post_effect_shader_program, post_effect_vertex_shader, post_effect_fragment_shader;
+
+    // create and compiler vertex shader
+    post_effect_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = post_effect_vertex_source.c_str();
+    length = post_effect_vertex_source.size();
+    glShaderSource(post_effect_vertex_shader, 1, &source, &length);
+    glCompileShader(post_effect_vertex_shader);
+    if(!check_shader_compile_status(post_effect_vertex_shader))
+    {
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    post_effect_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = post_effect_fragment_source.c_str();
+    length = post_effect_fragment_source.size();
+    glShaderSource(post_effect_fragment_shader, 1, &source, &length);
+    glCompileShader(post_effect_fragment_shader);
+    if(!check_shader_compile_status(post_effect_fragment_shader))
+    {
+        return 1;
+    }
+
+    // create program
+    post_effect_shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(post_effect_shader_program, post_effect_vertex_shader);
+    glAttachShader(post_effect_shader_program, post_effect_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(post_effect_shader_program);
+    check_program_link_status(post_effect_shader_program);
+
+    // get texture uniform location
+    GLint post_effect_texture_location = glGetUniformLocation(post_effect_shader_program, "intexture");
+
+    // the histogram covers the log2 luminance range [-8, 8]. Bin 0 is
+    // reserved for black pixels which don't contribute to the average.
+    const std::string histogram_constants =
+        "const float minlog = -8.0;\n"
+        "const float rangelog = 16.0;\n";
+
+    // every workgroup accumulates a histogram in shared memory first
+    // and then adds it to the global one to reduce the contention on
+    // the global atomics
+    std::string histogram_source =
+        "#version 430\n"
+        "layout(local_size_x = 16, local_size_y = 16) in;\n"
+        "layout(binding = 0) uniform sampler2D scene;\n"
+        "layout(std430, binding = 0) buffer hblock { uint bins[256]; };\n"
+        + histogram_constants +
+        "shared uint localbins[256];\n"
+        "void main() {\n"
+        "   localbins[gl_LocalInvocationIndex] = 0u;\n"
+        "   barrier();\n"
+        "   ivec2 coord = ivec2(gl_GlobalInvocationID.xy);\n"
+        "   if(all(lessThan(coord, textureSize(scene, 0)))) {\n"
+        "       vec3 color = texelFetch(scene, coord, 0).rgb;\n"
+        "       float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));\n"
+        "       uint bin = 0u;\n"
+        "       if(luminance > exp2(minlog))\n"
+        "           bin = uint(clamp((log2(luminance)-minlog)/rangelog, 0.0, 1.0)*254.0+1.0);\n"
+        "       atomicAdd(localbins[bin], 1u);\n"
+        "   }\n"
+        "   barrier();\n"
+        "   atomicAdd(bins[gl_LocalInvocationIndex], localbins[gl_LocalInvocationIndex]);\n"
+        "}\n";
+
+    // a single workgroup reduces the histogram to the average log
+    // luminance, moves the adapted luminance towards it and clears
+    // the histogram for the next frame
+    std::string average_source =
+        "#version 430\n"
+        "layout(local_size_x = 256) in;\n"
+        "layout(location = 0) uniform float adaptation;\n"
+        "layout(location = 1) uniform uint pixelcount;\n"
+        "layout(std430, binding = 0) buffer hblock { uint bins[256]; };\n"
+        "layout(std430, binding = 1) buffer eblock { float averagelum; };\n"
+        + histogram_constants +
+        "shared float weighted[256];\n"
+        "void main() {\n"
+        "   uint i = gl_LocalInvocationIndex;\n"
+        "   uint count = bins[i];\n"
+        "   weighted[i] = float(count)*float(i);\n"
+        "   bins[i] = 0u;\n"
+        "   barrier();\n"
+        "   for(uint stride = 128u;stride>0u;stride>>=1) {\n"
+        "       if(i<stride)\n"
+        "           weighted[i] += weighted[i+stride];\n"
+        "       barrier();\n"
+        "   }\n"
+        "   if(i == 0) {\n"
+        // count is the number of black pixels for the first invocation
+        "       float nonblack = max(float(pixelcount)-float(count), 1.0);\n"
+        "       float avglog = (weighted[0]/nonblack-1.0)/254.0*rangelog+minlog;\n"
+        "       averagelum += (exp2(avglog)-averagelum)*adaptation;\n"
+        "   }\n"
+        "}\n";
+
+    // the tonemapping pass reads the adapted luminance directly from the
+    // buffer written by the compute shader and writes luma to alpha for fxaa
+    std::string tonemap_fragment_source =
+        "#version 430\n"
+        "layout(binding = 0) uniform sampler2D scene;\n"
+        "layout(location = 0) uniform int autoexposure;\n"
+        "layout(std430, binding = 1) readonly buffer eblock { float averagelum; };\n"
+        "in vec2 ftexcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   vec3 color = textureLod(scene, ftexcoord, 0.0).rgb;\n"
+        "   float exposure = autoexposure != 0 ? 0.18/averagelum : 1.0;\n"
+        "   color = 1.0-exp(-exposure*color);\n"
+        "   FragColor = vec4(color, dot(color, vec3(0.299, 0.587, 0.114)));\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint histogram_program, histogram_shader;
+    GLuint average_program, average_shader;
+    GLuint tonemap_program, tonemap_fragment_shader;
+
+    // create and compiler compute shader
+    histogram_shader = glCreateShader(GL_COMPUTE_SHADER);
+    source = histogram_source.c_str();
+    length = histogram_source.size();
+    glShaderSource(histogram_shader, 1, &source, &length);
+    glCompileShader(histogram_shader);
+    if(!check_shader_compile_status(histogram_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler compute shader
+    average_shader = glCreateShader(GL_COMPUTE_SHADER);
+    source = average_source.c_str();
+    length = average_source.size();
+    glShaderSource(average_shader, 1, &source, &length);
+    glCompileShader(average_shader);
+    if(!check_shader_compile_status(average_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    tonemap_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = tonemap_fragment_source.c_str();
+    length = tonemap_fragment_source.size();
+    glShaderSource(tonemap_fragment_shader, 1, &source, &length);
+    glCompileShader(tonemap_fragment_shader);
+    if(!check_shader_compile_status(tonemap_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create programs
+    histogram_program = glCreateProgram();
+    average_program = glCreateProgram();
+    tonemap_program = glCreateProgram();
+
+    // attach shaders, the tonemapping pass shares the vertex shader
+    // with the fxaa pass
+    glAttachShader(histogram_program, histogram_shader);
+    glAttachShader(average_program, average_shader);
+    glAttachShader(tonemap_program, post_effect_vertex_shader);
+    glAttachShader(tonemap_program, tonemap_fragment_shader);
+
+    // link the programs and check for errors
+    glLinkProgram(histogram_program);
+    check_program_link_status(histogram_program);
+    glLinkProgram(average_program);
+    check_program_link_status(average_program);
+    glLinkProgram(tonemap_program);
+    check_program_link_status(tonemap_program);
+
+    // vao and vbo handle
+    GLuint post_effect_vao, post_effect_vbo, post_effect_ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &post_effect_vao);
+    glBindVertexArray(post_effect_vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &post_effect_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, post_effect_vbo);
+
+    // data for a fullscreen quad (this time with texture coords)
+    GLfloat post_effect_vertexData[] = {
+    //  X     Y     Z           U     V
+       1.0f, 1.0f, 0.0f,       1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f, 0.0f,       0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f, 0.0f,       1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 0.0f,       0.0f, 0.0f, // vertex 3
+    }; // 4 vertices with 5 components (floats) each
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*4*5, post_effect_vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &post_effect_ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, post_effect_ibo);
+
+    GLuint post_effect_indexData[] = {
+        0,1,2, // first triangle
+        2,1,3, // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*2*3, post_effect_indexData, GL_STATIC_DRAW);
+
+    // "unbind" vao
+    glBindVertexArray(0);
+
+    // hdr and ldr texture handles
+    GLuint hdr_texture, ldr_texture;
+
+    // generate textures
+    glGenTextures(1, &hdr_texture);
+    glGenTextures(1, &ldr_texture);
+
+    // the hdr texture is sampled at the pixel centers only
+    glBindTexture(GL_TEXTURE_2D, hdr_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // the ldr texture is the fxaa input
+    glBindTexture(GL_TEXTURE_2D, ldr_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    // renderbuffer handle
+    GLuint rbf;
+
+    // generate renderbuffers
+    glGenRenderbuffers(1, &rbf);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, rbf);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    // framebuffer handles
+    GLuint hdr_fbo, ldr_fbo;
+
+    // generate framebuffers
+    glGenFramebuffers(1, &hdr_fbo);
+    glGenFramebuffers(1, &ldr_fbo);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, ldr_fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, ldr_texture, 0);
+
+    // histogram and exposure buffers
+    GLuint histogram_ssbo, exposure_ssbo;
+
+    glGenBuffers(1, &histogram_ssbo);
+    glGenBuffers(1, &exposure_ssbo);
+
+    // the histogram starts out empty and is cleared by the average
+    // shader after that
+    std::vector<GLuint> histogramData(256, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogram_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint)*256, &histogramData[0], GL_DYNAMIC_COPY);
+
+    GLfloat exposureData = 1.0f;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposure_ssbo);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLfloat), &exposureData, GL_DYNAMIC_COPY);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, histogram_ssbo);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, exposure_ssbo);
+
+    // setup uniforms
+    glUseProgram(average_program);
+    glUniform1ui(1, width*height);
+
+    // timer query setup, one query for each pass
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint scene_queries[querycount], exposure_queries[querycount], post_queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, scene_queries);
+    glGenQueries(querycount, exposure_queries);
+    glGenQueries(querycount, post_queries);
+
+    // the hdr target is (re)allocated when the format changes
+    const GLenum formats[2] = {GL_R11F_G11F_B10F, GL_RGBA16F};
+    const int bytesperpixel[2] = {4, 8};
+    int format = -1;
+
+    float last_t = glfwGetTime();
+
+    bool autoexposure = true;
+    bool space_down = false;
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+        float dt = t - last_t;
+        last_t = t;
+
+        // toggle auto exposure with space
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down)
+        {
+            autoexposure = !autoexposure;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // select the hdr format
+        int selected = format < 0 ? 0 : format;
+        if(glfwGetKey(window, GLFW_KEY_1))
+            selected = 0;
+        if(glfwGetKey(window, GLFW_KEY_2))
+            selected = 1;
+        if(selected != format) {
+            format = selected;
+            glBindTexture(GL_TEXTURE_2D, hdr_texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, formats[format], width, height, 0, GL_RGBA, GL_FLOAT, 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, hdr_fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, hdr_texture, 0);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbf);
+            std::cout << "hdr target: " << bytesperpixel[format] << " bytes/pixel, "
+                      << bytesperpixel[format]*width*height/1024 << " kB" << std::endl;
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, scene_queries[current_query]);
+
+        glEnable(GL_DEPTH_TEST);
+
+        // bind target framebuffer
+        glBindFramebuffer(GL_FRAMEBUFFER, hdr_fbo);
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*t, glm::vec3(1.0f, 1.0f, 1.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniforms, the overall intensity slowly changes over
+        // several orders of magnitude so the adaptation is visible
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1f(intensity_location, std::pow(2.0f, 6.0f*std::sin(0.2f*t)));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, 8*8*8);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        glBeginQuery(GL_TIME_ELAPSED, exposure_queries[current_query]);
+
+        // build the histogram
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hdr_texture);
+        glUseProgram(histogram_program);
+        glDispatchCompute((width+15)/16, (height+15)/16, 1);
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        // reduce it and adapt the exposure, the adaptation rate is
+        // independent of the frame rate
+        glUseProgram(average_program);
+        glUniform1f(0, 1.0f-std::exp(-2.0f*dt));
+        glDispatchCompute(1, 1, 1);
+
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        glBeginQuery(GL_TIME_ELAPSED, post_queries[current_query]);
+
+        // we are not 3d rendering so no depth test
+        glDisable(GL_DEPTH_TEST);
+
+        // bind the vao
+        glBindVertexArray(post_effect_vao);
+
+        // tonemap into the ldr texture
+        glBindFramebuffer(GL_FRAMEBUFFER, ldr_fbo);
+        glUseProgram(tonemap_program);
+        glUniform1i(0, autoexposure);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        // apply fxaa and write to the window
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glUseProgram(post_effect_shader_program);
+        glBindTexture(GL_TEXTURE_2D, ldr_texture);
+        glUniform1i(post_effect_texture_location, 0);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(scene_queries[(current_query+1)%querycount])) {
+            GLuint64 scene_result, exposure_result, post_result;
+            glGetQueryObjectui64v(scene_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &scene_result);
+            glGetQueryObjectui64v(exposure_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &exposure_result);
+            glGetQueryObjectui64v(post_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &post_result);
+            std::cout << scene_result*1.e-6 << " ms scene " << exposure_result*1.e-6 << " ms exposure "
+                      << post_result*1.e-6 << " ms tonemap+fxaa" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(querycount, scene_queries);
+    glDeleteQueries(querycount, exposure_queries);
+    glDeleteQueries(querycount, post_queries);
+
+    glDeleteBuffers(1, &histogram_ssbo);
+    glDeleteBuffers(1, &exposure_ssbo);
+
+    glDeleteFramebuffers(1, &hdr_fbo);
+    glDeleteFramebuffers(1, &ldr_fbo);
+    glDeleteRenderbuffers(1, &rbf);
+    glDeleteTextures(1, &hdr_texture);
+    glDeleteTextures(1, &ldr_texture);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDeleteVertexArrays(1, &post_effect_vao);
+    glDeleteBuffers(1, &post_effect_vbo);
+    glDeleteBuffers(1, &post_effect_ibo);
+
+    glDetachShader(post_effect_shader_program, post_effect_vertex_shader);
+    glDetachShader(post_effect_shader_program, post_effect_fragment_shader);
+    glDeleteShader(post_effect_vertex_shader);
+    glDeleteShader(post_effect_fragment_shader);
+    glDeleteProgram(post_effect_shader_program);
+
+    glDetachShader(histogram_program, histogram_shader);
+    glDeleteShader(histogram_shader);
+    glDeleteProgram(histogram_program);
+
+    glDetachShader(average_program, average_shader);
+    glDeleteShader(average_shader);
+    glDeleteProgram(average_program);
+
+    glDetachShader(tonemap_program, post_effect_vertex_shader);
+    glDetachShader(tonemap_program, tonemap_fragment_shader);
+    glDeleteShader(tonemap_fragment_shader);
+    glDeleteProgram(tonemap_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
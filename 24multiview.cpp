@@ -0,0 +1,710 @@
+/* OpenGL example code - multiview
+ *
+ * This example renders the voxel landscape from the queries example
+ * as a stereo pair into two halves of the window. There are three
+ * ways to render the views:
+ * 1: two passes, every chunk is drawn once per view
+ * 2: single pass with viewport arrays, every chunk is drawn once with
+ *    two instances and the instance id selects the view matrix and
+ *    gl_ViewportIndex
+ * 3: single pass with a layered target, the instance id selects
+ *    gl_Layer of a 2D array texture and the layers are blitted to
+ *    the window afterwards
+ * If GL_ARB_shader_viewport_layer_array is available the vertex shader
+ * writes gl_ViewportIndex/gl_Layer directly, otherwise a pass through
+ * geometry shader is used. The single pass modes halve the number of
+ * draw calls and state changes. The CPU time spent submitting the
+ * draws and the GPU time are printed every frame.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ * select the mode with 1-3
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    int quadcount;
+    glm::vec3 center;
+};
+
+// predicate to allow sorting chunks by distance from a point
+class DistancePred {
+public:
+    DistancePred(glm::vec3 p) : pos(p) { }
+    bool operator()(const Chunk &a, const Chunk &b) {
+        return glm::distance(pos, a.center) < glm::distance(pos, b.center);
+    }
+private:
+    const glm::vec3 pos;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// same conservative frustum test as in the queries example
+bool outside_frustum(const Chunk &chunk, glm::vec3 position, const glm::mat4 &ViewProjection, float chunksize) {
+    glm::vec4 projected = ViewProjection*glm::vec4(chunk.center,1);
+    return (glm::distance(chunk.center,position) > chunksize) &&
+           (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize);
+}
+
+// helper to check if an extension is supported
+bool has_extension(const char *name) {
+    GLint count;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0;i<count;++i)
+        if(std::strcmp(name, reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))) == 0)
+            return true;
+    return false;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "24multiview", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // draw shader for the two pass mode
+    std::string vertex_source =
+        "#version 410\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 410\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = abs(fcolor);\n"
+        "}\n";
+
+    // multiview shaders, the instance id is the view index. The layered
+    // uniform selects whether the view is routed to a layer or viewport.
+    bool vertex_layer = has_extension("GL_ARB_shader_viewport_layer_array");
+    std::cout << (vertex_layer ? "routing views in the vertex shader" : "routing views in a geometry shader") << std::endl;
+
+    std::string multiview_vertex_source =
+        "#version 410\n"
+        "#extension GL_ARB_shader_viewport_layer_array : require\n"
+        "uniform mat4 ViewProjection[2];\n"
+        "uniform int layered;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection[gl_InstanceID]*vposition;\n"
+        "   gl_Layer = layered!=0 ? gl_InstanceID : 0;\n"
+        "   gl_ViewportIndex = layered!=0 ? 0 : gl_InstanceID;\n"
+        "}\n";
+
+    // without the extension the vertex shader only passes on the
+    // view index and the geometry shader does the routing
+    std::string fallback_vertex_source =
+        "#version 410\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 gcolor;\n"
+        "flat out int gview;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   gcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gview = gl_InstanceID;\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    std::string fallback_geometry_source =
+        "#version 410\n"
+        "uniform mat4 ViewProjection[2];\n"
+        "uniform int layered;\n"
+        "layout(triangles) in;\n"
+        "layout(triangle_strip, max_vertices = 3) out;\n"
+        "in vec4 gcolor[];\n"
+        "flat in int gview[];\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   for(int i = 0;i<3;++i) {\n"
+        "       fcolor = gcolor[i];\n"
+        "       gl_Position = ViewProjection[gview[0]]*gl_in[i].gl_Position;\n"
+        "       gl_Layer = layered!=0 ? gview[0] : 0;\n"
+        "       gl_ViewportIndex = layered!=0 ? 0 : gview[0];\n"
+        "       EmitVertex();\n"
+        "   }\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+    GLuint multiview_program, multiview_vertex_shader, multiview_geometry_shader = 0;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler multiview vertex shader
+    multiview_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    if(vertex_layer) {
+        source = multiview_vertex_source.c_str();
+        length = multiview_vertex_source.size();
+    } else {
+        source = fallback_vertex_source.c_str();
+        length = fallback_vertex_source.size();
+    }
+    glShaderSource(multiview_vertex_shader, 1, &source, &length);
+    glCompileShader(multiview_vertex_shader);
+    if(!check_shader_compile_status(multiview_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler the geometry shader if required
+    if(!vertex_layer) {
+        multiview_geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
+        source = fallback_geometry_source.c_str();
+        length = fallback_geometry_source.size();
+        glShaderSource(multiview_geometry_shader, 1, &source, &length);
+        glCompileShader(multiview_geometry_shader);
+        if(!check_shader_compile_status(multiview_geometry_shader)) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 1;
+        }
+    }
+
+    // create programs
+    shader_program = glCreateProgram();
+    multiview_program = glCreateProgram();
+
+    // attach shaders, the fragment shader is shared
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    glAttachShader(multiview_program, multiview_vertex_shader);
+    if(!vertex_layer)
+        glAttachShader(multiview_program, multiview_geometry_shader);
+    glAttachShader(multiview_program, fragment_shader);
+
+    // link the programs and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+    glLinkProgram(multiview_program);
+    check_program_link_status(multiview_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint MultiViewProjection_location = glGetUniformLocation(multiview_program, "ViewProjection");
+    GLint layered_location = glGetUniformLocation(multiview_program, "layered");
+
+    // chunk container and chunk parameters
+    std::vector<Chunk> chunks;
+    int chunkrange = 4;
+    int chunksize = 32;
+
+    // chunk extraction
+    std::cout << "generating chunks, this may take a while." << std::endl;
+
+    // iterate over all chunks we want to extract
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+
+        // chunk data
+
+        // generate and bind the vao
+        glGenVertexArrays(1, &chunk.vao);
+        glBindVertexArray(chunk.vao);
+
+        // generate and bind the vertex buffer object
+        glGenBuffers(1, &chunk.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        float threshold = 0.0f;
+        // iterate over all blocks within the chunk
+        for(int x = 0;x<chunksize;++x) {
+            for(int y = 0;y<chunksize;++y)  {
+                for(int z = 0;z<chunksize;++z) {
+                    glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                    // insert quads if current block is solid and neighbors are not
+                    if(world_function(pos)<threshold) {
+                        if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                        }
+                        if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                        }
+                    }
+                }
+            }
+        }
+        // upload
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), &vertexData[0], GL_STATIC_DRAW);
+
+        // set up generic attrib pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+        // generate and bind the index buffer object
+        glGenBuffers(1, &chunk.ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo);
+
+        chunk.quadcount = vertexData.size()/8;
+        std::vector<GLuint> indexData(6*chunk.quadcount);
+        for(int i = 0;i<chunk.quadcount;++i) {
+            indexData[6*i + 0] = 4*i + 0;
+            indexData[6*i + 1] = 4*i + 1;
+            indexData[6*i + 2] = 4*i + 2;
+            indexData[6*i + 3] = 4*i + 2;
+            indexData[6*i + 4] = 4*i + 1;
+            indexData[6*i + 5] = 4*i + 3;
+        }
+
+        // upload
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), &indexData[0], GL_STATIC_DRAW);
+
+        // set the center location of the chunk
+        chunk.center = offset + 0.5f*chunksize;
+
+        // add to container
+        chunks.push_back(chunk);
+    }
+
+    // each view covers half of the window
+    int viewwidth = width/2;
+    int viewheight = height;
+
+    // layered color and depth targets with one layer per view
+    GLuint layered_color, layered_depth;
+
+    glGenTextures(1, &layered_color);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, layered_color);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, viewwidth, viewheight, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    glGenTextures(1, &layered_depth);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, layered_depth);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT24, viewwidth, viewheight, 2, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 0);
+
+    // the layered fbo is rendered to, the per layer fbos are used
+    // to blit the individual layers to the window
+    GLuint layered_fbo, layer_fbo[2];
+
+    glGenFramebuffers(1, &layered_fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, layered_fbo);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, layered_color, 0);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, layered_depth, 0);
+
+    glGenFramebuffers(2, layer_fbo);
+    for(int i = 0;i<2;++i) {
+        glBindFramebuffer(GL_FRAMEBUFFER, layer_fbo[i]);
+        glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, layered_color, 0, i);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // timer query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // set clear color to sky blue
+    glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    // distance between the eyes
+    const float eyeseparation = 0.5f;
+
+    int mode = 0;
+    const char *modenames[3] = {"two pass", "viewport array", "layered"};
+
+    float t = glfwGetTime();
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // select the mode
+        for(int i = 0;i<3;++i) {
+            if(glfwGetKey(window, GLFW_KEY_1+i) && mode != i) {
+                mode = i;
+                std::cout << modenames[mode] << std::endl;
+            }
+        }
+
+        // calculate ViewProjection matrices, the eyes are offset
+        // along the view space x axis
+        glm::mat4 Projection = glm::perspective(60.0f, float(viewwidth) / viewheight, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection[2];
+        for(int i = 0;i<2;++i) {
+            glm::mat4 Eye = glm::translate(glm::mat4(1.0f), glm::vec3((i==0?0.5f:-0.5f)*eyeseparation, 0.0f, 0.0f));
+            ViewProjection[i] = Projection*Eye*View;
+        }
+
+        // sort chunks by distance
+        std::sort(chunks.begin(), chunks.end(), DistancePred(position));
+
+        // start timer query
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        // measure the time spent submitting draw calls
+        double submit_start = glfwGetTime();
+        int drawcalls = 0;
+
+        if(mode == 0) {
+            // clear and render each view separately
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glViewport(0, 0, width, height);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            glUseProgram(shader_program);
+            for(int view = 0;view<2;++view) {
+                glViewport(view*viewwidth, 0, viewwidth, viewheight);
+                glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection[view]));
+                for(size_t i = 0;i<chunks.size();++i) {
+                    // frustum culling
+                    if(outside_frustum(chunks[i], position, ViewProjection[view], chunksize))
+                        continue;
+
+                    // draw chunk
+                    glBindVertexArray(chunks[i].vao);
+                    glDrawElements(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, 0);
+                    ++drawcalls;
+                }
+            }
+        } else {
+            bool layered = mode == 2;
+
+            // the viewport mode renders directly to the window and the
+            // layered mode to the array texture
+            if(layered) {
+                glBindFramebuffer(GL_FRAMEBUFFER, layered_fbo);
+                glViewport(0, 0, viewwidth, viewheight);
+            } else {
+                // glViewport sets all viewports so the array has to
+                // be set up again
+                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                glViewportIndexedf(0, 0, 0, viewwidth, viewheight);
+                glViewportIndexedf(1, viewwidth, 0, viewwidth, viewheight);
+            }
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            glUseProgram(multiview_program);
+            glUniformMatrix4fv(MultiViewProjection_location, 2, GL_FALSE, glm::value_ptr(ViewProjection[0]));
+            glUniform1i(layered_location, layered);
+            for(size_t i = 0;i<chunks.size();++i) {
+                // frustum culling, chunks visible in either view are drawn
+                if(outside_frustum(chunks[i], position, ViewProjection[0], chunksize) &&
+                   outside_frustum(chunks[i], position, ViewProjection[1], chunksize))
+                    continue;
+
+                // draw chunk once for both views
+                glBindVertexArray(chunks[i].vao);
+                glDrawElementsInstanced(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, 0, 2);
+                ++drawcalls;
+            }
+
+            // copy the layers to the window
+            if(layered) {
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                for(int view = 0;view<2;++view) {
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, layer_fbo[view]);
+                    glBlitFramebuffer(0, 0, viewwidth, viewheight,
+                                      view*viewwidth, 0, (view+1)*viewwidth, viewheight,
+                                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                }
+            }
+        }
+
+        double submit_time = glfwGetTime() - submit_start;
+
+        // end timer query
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+            std::cout << modenames[mode] << ": " << drawcalls << " draws "
+                      << submit_time*1.e3 << " ms cpu "
+                      << result*1.e-6 << " ms gpu" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+        glDeleteBuffers(1, &chunks[i].ibo);
+    }
+
+    glDeleteQueries(querycount, queries);
+
+    glDeleteFramebuffers(1, &layered_fbo);
+    glDeleteFramebuffers(2, layer_fbo);
+    glDeleteTextures(1, &layered_color);
+    glDeleteTextures(1, &layered_depth);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(multiview_program, multiview_vertex_shader);
+    if(!vertex_layer)
+        glDetachShader(multiview_program, multiview_geometry_shader);
+    glDetachShader(multiview_program, fragment_shader);
+    glDeleteProgram(multiview_program);
+
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteShader(multiview_vertex_shader);
+    if(!vertex_layer)
+        glDeleteShader(multiview_geometry_shader);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,571 @@
+/* OpenGL example code - late latching
+ *
+ * This example renders the voxel landscape from the queries example
+ * with the camera matrix stored in a persistently mapped uniform
+ * buffer. Since the draw calls only reference the buffer, the matrix
+ * can be written after the frame has been submitted, right before
+ * the commands are flushed. This reduces the delay between reading the
+ * mouse and the frame that shows the result by the time spent in the
+ * CPU side work of the frame. The buffer has one slot per frame in
+ * flight which are protected by fences.
+ *
+ * The input-to-submit latency is measured on the CPU. The
+ * input-to-present latency is approximated with a GL_TIMESTAMP query
+ * after the buffer swap that is converted to CPU time.
+ *
+ * Note that the driver is free to start executing commands before the
+ * flush, in that case parts of the frame may still see the early matrix.
+ * The frustum culling uses the matrix from the start of the frame and
+ * relies on the conservative margin of the culling test.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ * toggle late latching with space
+ * increase/decrease the simulated CPU work with up/down
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    int quadcount;
+    glm::vec3 center;
+};
+
+// predicate to allow sorting chunks by distance from a point
+class DistancePred {
+public:
+    DistancePred(glm::vec3 p) : pos(p) { }
+    bool operator()(const Chunk &a, const Chunk &b) {
+        return glm::distance(pos, a.center) < glm::distance(pos, b.center);
+    }
+private:
+    const glm::vec3 pos;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// read the mouse movement since the last call and apply it to the
+// camera rotation
+void apply_mouse(GLFWwindow *window, double &mousex, double &mousey, glm::mat4 &rotation) {
+    double tmpx, tmpy;
+    glfwGetCursorPos(window, &tmpx, &tmpy);
+    glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+    mousex = tmpx;
+    mousey = tmpy;
+
+    glm::mat3 rotation3(rotation);
+    glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+
+    rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+    rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "25late_latching", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // draw shader, the matrix comes from a uniform block
+    std::string vertex_source =
+        "#version 440\n"
+        "layout(std140, binding = 0) uniform Camera {\n"
+        "   mat4 ViewProjection;\n"
+        "};\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 440\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = abs(fcolor);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // chunk container and chunk parameters
+    std::vector<Chunk> chunks;
+    int chunkrange = 4;
+    int chunksize = 32;
+
+    // chunk extraction
+    std::cout << "generating chunks, this may take a while." << std::endl;
+
+    // iterate over all chunks we want to extract
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+
+        // chunk data
+
+        // generate and bind the vao
+        glGenVertexArrays(1, &chunk.vao);
+        glBindVertexArray(chunk.vao);
+
+        // generate and bind the vertex buffer object
+        glGenBuffers(1, &chunk.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        float threshold = 0.0f;
+        // iterate over all blocks within the chunk
+        for(int x = 0;x<chunksize;++x) {
+            for(int y = 0;y<chunksize;++y)  {
+                for(int z = 0;z<chunksize;++z) {
+                    glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                    // insert quads if current block is solid and neighbors are not
+                    if(world_function(pos)<threshold) {
+                        if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                        }
+                        if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                        }
+                    }
+                }
+            }
+        }
+        // upload
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), &vertexData[0], GL_STATIC_DRAW);
+
+        // set up generic attrib pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+        // generate and bind the index buffer object
+        glGenBuffers(1, &chunk.ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo);
+
+        chunk.quadcount = vertexData.size()/8;
+        std::vector<GLuint> indexData(6*chunk.quadcount);
+        for(int i = 0;i<chunk.quadcount;++i) {
+            indexData[6*i + 0] = 4*i + 0;
+            indexData[6*i + 1] = 4*i + 1;
+            indexData[6*i + 2] = 4*i + 2;
+            indexData[6*i + 3] = 4*i + 2;
+            indexData[6*i + 4] = 4*i + 1;
+            indexData[6*i + 5] = 4*i + 3;
+        }
+
+        // upload
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), &indexData[0], GL_STATIC_DRAW);
+
+        // set the center location of the chunk
+        chunk.center = offset + 0.5f*chunksize;
+
+        // add to container
+        chunks.push_back(chunk);
+    }
+
+    // camera buffer with one slot per frame in flight, the slots
+    // have to respect the uniform buffer offset alignment
+    const int slotcount = 3;
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    GLsizeiptr slotsize = ((sizeof(glm::mat4)+alignment-1)/alignment)*alignment;
+
+    GLuint camera_ubo;
+    glGenBuffers(1, &camera_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+
+    // the buffer stays mapped for the whole lifetime and coherent
+    // mapping makes the writes visible without explicit flushes
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_UNIFORM_BUFFER, slotcount*slotsize, 0, flags);
+    char *camera_data = static_cast<char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, slotcount*slotsize, flags));
+
+    // fences that protect the slots from being overwritten while
+    // the GPU still reads them
+    GLsync fences[slotcount] = {0, 0, 0};
+    int current_slot = 0;
+
+    // timestamp query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    double input_times[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    // offset to convert GL timestamps to glfw time
+    GLint64 gpu_time;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_time);
+    double gpu_time_offset = glfwGetTime() - gpu_time*1.e-9;
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // set clear color to sky blue
+    glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+    glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 200.f);
+
+    // the storage is uninitialized, start every slot with a valid matrix
+    for(int i = 0;i<slotcount;++i)
+        *reinterpret_cast<glm::mat4*>(camera_data + i*slotsize) = Projection*rotation;
+
+    // simulated CPU work per frame in milliseconds
+    float cpu_work = 8.0f;
+
+    float t = glfwGetTime();
+    bool late_latch = true;
+    bool space_down = false;
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // the early input sample, in the late latching mode this is
+        // only used for culling
+        apply_mouse(window, mousex, mousey, rotation);
+        double input_time = glfwGetTime();
+
+        // find forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // toggle late latching
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            late_latch = !late_latch;
+            std::cout << (late_latch ? "late latching on" : "late latching off") << std::endl;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // adjust the simulated CPU work
+        if(glfwGetKey(window, GLFW_KEY_UP))
+            cpu_work += 10.0f*dt;
+        if(glfwGetKey(window, GLFW_KEY_DOWN))
+            cpu_work = std::max(0.0f, cpu_work-10.0f*dt);
+
+        // wait until the GPU is done with the slot we are about to reuse
+        if(fences[current_slot]) {
+            glClientWaitSync(fences[current_slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(fences[current_slot]);
+            fences[current_slot] = 0;
+        }
+        glm::mat4 *camera_slot = reinterpret_cast<glm::mat4*>(camera_data + current_slot*slotsize);
+
+        // calculate ViewProjection matrix
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // the early matrix is always written before the draws, late
+        // latching only replaces it with a more recent one
+        *camera_slot = ViewProjection;
+
+        // simulate the CPU work of a frame (game logic etc.)
+        while(glfwGetTime() < input_time + cpu_work*1.e-3) { }
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // sort chunks by distance
+        std::sort(chunks.begin(), chunks.end(), DistancePred(position));
+
+        // use the slot of this frame
+        glUseProgram(shader_program);
+        glBindBufferRange(GL_UNIFORM_BUFFER, 0, camera_ubo, current_slot*slotsize, sizeof(glm::mat4));
+
+        for(size_t i = 0;i<chunks.size();++i) {
+            // frustum culling
+            glm::vec4 projected = ViewProjection*glm::vec4(chunks[i].center,1);
+            if( (glm::distance(chunks[i].center,position) > chunksize) &&
+                (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize))
+                continue;
+
+            // draw chunk
+            glBindVertexArray(chunks[i].vao);
+            glDrawElements(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, 0);
+        }
+
+        // sample the input again and write the matrix just before the
+        // commands are flushed
+        if(late_latch) {
+            glfwPollEvents();
+            apply_mouse(window, mousex, mousey, rotation);
+            input_time = glfwGetTime();
+            View = rotation*glm::translate(glm::mat4(1.0f), -position);
+            *camera_slot = Projection*View;
+        }
+
+        fences[current_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current_slot = (current_slot + 1)%slotcount;
+
+        glFlush();
+        double submit_latency = glfwGetTime() - input_time;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        // the timestamp is written when the GPU has finished the frame
+        glQueryCounter(queries[current_query], GL_TIMESTAMP);
+        input_times[current_query] = input_time;
+
+        // display latencies, the present latency is from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+            double present_latency = result*1.e-9 + gpu_time_offset - input_times[(current_query+1)%querycount];
+            std::cout << submit_latency*1.e3 << " ms input to submit "
+                      << present_latency*1.e3 << " ms input to present" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+    }
+
+    // delete the created objects
+
+    for(int i = 0;i<slotcount;++i)
+        if(fences[i])
+            glDeleteSync(fences[i]);
+
+    glBindBuffer(GL_UNIFORM_BUFFER, camera_ubo);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glDeleteBuffers(1, &camera_ubo);
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+        glDeleteBuffers(1, &chunks[i].ibo);
+    }
+
+    glDeleteQueries(querycount, queries);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
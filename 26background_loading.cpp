@@ -0,0 +1,694 @@
+/* OpenGL example code - background loading
+ *
+ * This example renders the voxel landscape from the queries example
+ * but instead of generating all chunks before the first frame, the
+ * chunks and a detail texture are generated and uploaded by a loader
+ * thread. The loader thread owns a hidden window whose context shares
+ * its objects with the main context. Every upload is followed by a
+ * fence and the render thread only uses an object once its fence is
+ * signaled. The render thread then calls the completion callback of
+ * the upload which creates the vertex array objects (those are not
+ * shared between contexts) and adds the chunk to the scene.
+ * The first frame appears immediately and the content streams in
+ * nearest chunk first.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// an upload job, prepare runs on the loader thread and fills in the
+// data. The loader then creates and fills the buffer or texture.
+// complete is called on the render thread once the upload is done.
+struct Upload {
+    enum Kind { BUFFER, TEXTURE };
+
+    Upload() : kind(BUFFER), width(0), height(0), internalformat(0), format(0), type(0),
+               count(0), offset(0), object(0), fence(0) { }
+
+    Kind kind;
+    std::function<void(Upload&)> prepare;
+    std::function<void(Upload&)> complete;
+
+    // the data to upload, for textures also the format
+    std::vector<char> data;
+    GLsizei width, height;
+    GLenum internalformat, format, type;
+
+    // user data that is passed from prepare to complete
+    int count;
+    size_t offset;
+    glm::vec3 position;
+
+    // the created object and the fence after its upload
+    GLuint object;
+    GLsync fence;
+};
+
+// loader thread with its own context that shares objects with the
+// context of the render thread
+class ResourceLoader {
+public:
+    ResourceLoader(GLFWwindow *shared) : running(true) {
+        // the loader context lives in a hidden window
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+        window = glfwCreateWindow(1, 1, "loader", 0, shared);
+        glfwWindowHint(GLFW_VISIBLE, GL_TRUE);
+        if(window)
+            thread = std::thread(&ResourceLoader::run, this);
+    }
+
+    bool valid() const { return window != 0; }
+
+    // queue an upload, can be called from any thread
+    void load(const Upload &upload) {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.push_back(upload);
+        condition.notify_one();
+    }
+
+    // call the completion callbacks of all finished uploads whose
+    // fences are signaled, has to be called on the render thread
+    int poll() {
+        std::deque<Upload> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while(!finished.empty()) {
+                GLint status;
+                glGetSynciv(finished.front().fence, GL_SYNC_STATUS, 1, 0, &status);
+                if(status != GL_SIGNALED)
+                    break;
+                ready.push_back(finished.front());
+                finished.pop_front();
+            }
+        }
+        for(size_t i = 0;i<ready.size();++i) {
+            glDeleteSync(ready[i].fence);
+            ready[i].complete(ready[i]);
+        }
+        return ready.size();
+    }
+
+    // stop the loader thread, objects of uploads that didn't complete
+    // yet are deleted
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            condition.notify_one();
+        }
+        if(thread.joinable())
+            thread.join();
+        for(size_t i = 0;i<finished.size();++i) {
+            glDeleteSync(finished[i].fence);
+            if(finished[i].kind == Upload::BUFFER)
+                glDeleteBuffers(1, &finished[i].object);
+            else
+                glDeleteTextures(1, &finished[i].object);
+        }
+        finished.clear();
+        if(window)
+            glfwDestroyWindow(window);
+        window = 0;
+    }
+
+private:
+    void run() {
+        glfwMakeContextCurrent(window);
+        while(true) {
+            Upload upload;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(running && pending.empty())
+                    condition.wait(lock);
+                if(!running)
+                    break;
+                upload = pending.front();
+                pending.pop_front();
+            }
+
+            // the cpu side work doesn't hold the lock
+            upload.prepare(upload);
+
+            if(upload.kind == Upload::BUFFER) {
+                glGenBuffers(1, &upload.object);
+                glBindBuffer(GL_ARRAY_BUFFER, upload.object);
+                glBufferData(GL_ARRAY_BUFFER, upload.data.size(), upload.data.empty()?0:&upload.data[0], GL_STATIC_DRAW);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+            } else {
+                glGenTextures(1, &upload.object);
+                glBindTexture(GL_TEXTURE_2D, upload.object);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+                glTexImage2D(GL_TEXTURE_2D, 0, upload.internalformat, upload.width, upload.height, 0,
+                             upload.format, upload.type, &upload.data[0]);
+                glGenerateMipmap(GL_TEXTURE_2D);
+                glBindTexture(GL_TEXTURE_2D, 0);
+            }
+
+            // the fence has to be flushed so the other context can
+            // wait for it
+            upload.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            // the data isn't needed anymore
+            std::vector<char>().swap(upload.data);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            finished.push_back(upload);
+        }
+        glfwMakeContextCurrent(0);
+    }
+
+    GLFWwindow *window;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<Upload> pending;
+    std::deque<Upload> finished;
+    bool running;
+};
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, vao;
+    int quadcount;
+    size_t indexoffset;
+    glm::vec3 center;
+};
+
+// predicate to allow sorting positions by distance from a point
+class DistancePred {
+public:
+    DistancePred(glm::vec3 p) : pos(p) { }
+    bool operator()(const glm::vec3 &a, const glm::vec3 &b) {
+        return glm::distance(pos, a) < glm::distance(pos, b);
+    }
+private:
+    const glm::vec3 pos;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// prepare callback for chunks, the vertices and indices are stored in
+// the same buffer
+void prepare_chunk(Upload &upload, int chunksize) {
+    std::vector<glm::vec3> vertexData;
+    generate_chunk(upload.position, chunksize, vertexData);
+
+    upload.count = vertexData.size()/8;
+    std::vector<GLuint> indexData(6*upload.count);
+    for(int i = 0;i<upload.count;++i) {
+        indexData[6*i + 0] = 4*i + 0;
+        indexData[6*i + 1] = 4*i + 1;
+        indexData[6*i + 2] = 4*i + 2;
+        indexData[6*i + 3] = 4*i + 2;
+        indexData[6*i + 4] = 4*i + 1;
+        indexData[6*i + 5] = 4*i + 3;
+    }
+
+    upload.offset = sizeof(glm::vec3)*vertexData.size();
+    upload.data.resize(upload.offset + sizeof(GLuint)*indexData.size());
+    if(!vertexData.empty()) {
+        std::copy((char*)&vertexData[0], (char*)&vertexData[0]+upload.offset, upload.data.begin());
+        std::copy((char*)&indexData[0], (char*)&indexData[0]+sizeof(GLuint)*indexData.size(), upload.data.begin()+upload.offset);
+    }
+}
+
+// prepare callback for the detail texture
+void prepare_texture(Upload &upload) {
+    int size = 1024;
+    upload.width = size;
+    upload.height = size;
+    upload.internalformat = GL_R8;
+    upload.format = GL_RED;
+    upload.type = GL_UNSIGNED_BYTE;
+    upload.data.resize(size*size);
+    for(int y = 0;y<size;++y)
+        for(int x = 0;x<size;++x) {
+            // tileable noise with a period of 16 blocks
+            glm::vec2 pos = 16.0f*glm::vec2(x,y)/float(size);
+            float value = 0.5f*glm::perlin(pos, glm::vec2(16.0f)) + 0.25f*glm::perlin(2.0f*pos, glm::vec2(32.0f));
+            upload.data[y*size+x] = static_cast<unsigned char>(127.0f + 127.0f*value);
+        }
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    double start_time;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+    start_time = glfwGetTime();
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "26background_loading", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    // start the loader, uploads are only queued after glxwInit so the
+    // loader thread never calls an unloaded GL function
+    ResourceLoader loader(window);
+    if(!loader.valid()) {
+        std::cerr << "failed to create loader context" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        loader.stop();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // draw shader, the detail texture is sampled with the world
+    // position projected along the normal
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "out vec2 ftexcoord;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   vec3 n = abs(normal);\n"
+        "   ftexcoord = n.x>0.5 ? vposition.yz : (n.y>0.5 ? vposition.xz : vposition.xy);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "uniform sampler2D detail;\n"
+        "uniform int textured;\n"
+        "in vec4 fcolor;\n"
+        "in vec2 ftexcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   float value = textured!=0 ? 0.6+0.8*texture(detail, ftexcoord/16.0).r : 1.0;\n"
+        "   FragColor = value*abs(fcolor);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        loader.stop();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        loader.stop();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint detail_location = glGetUniformLocation(shader_program, "detail");
+    GLint textured_location = glGetUniformLocation(shader_program, "textured");
+
+    // chunk container and chunk parameters
+    std::vector<Chunk> chunks;
+    int chunkrange = 4;
+    int chunksize = 32;
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    // the texture is 0 until it is loaded
+    GLuint detail_texture = 0;
+
+    // queue the chunks nearest first so the surroundings of the
+    // camera appear first
+    std::vector<glm::vec3> offsets;
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k)
+                offsets.push_back(static_cast<float>(chunksize) * glm::vec3(i,j,k));
+    std::sort(offsets.begin(), offsets.end(), DistancePred(position-0.5f*chunksize));
+
+    int chunkcount = offsets.size();
+    for(int i = 0;i<chunkcount;++i) {
+        Upload upload;
+        upload.kind = Upload::BUFFER;
+        upload.position = offsets[i];
+        upload.prepare = std::bind(prepare_chunk, std::placeholders::_1, chunksize);
+
+        // vaos are not shared so they are created on the render thread
+        upload.complete = [&chunks, chunksize](Upload &done) {
+            Chunk chunk;
+            chunk.vbo = done.object;
+            chunk.quadcount = done.count;
+            chunk.indexoffset = done.offset;
+            chunk.center = done.position + 0.5f*chunksize;
+
+            glGenVertexArrays(1, &chunk.vao);
+            glBindVertexArray(chunk.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+            // the indices follow the vertices in the same buffer
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.vbo);
+
+            glBindVertexArray(0);
+            chunks.push_back(chunk);
+        };
+        loader.load(upload);
+
+        // queue the texture after the nearest chunks
+        if(i == 8) {
+            Upload texture_upload;
+            texture_upload.kind = Upload::TEXTURE;
+            texture_upload.prepare = prepare_texture;
+            texture_upload.complete = [&detail_texture, start_time](Upload &done) {
+                detail_texture = done.object;
+                std::cout << "texture ready after " << (glfwGetTime()-start_time)*1.e3 << " ms" << std::endl;
+            };
+            loader.load(texture_upload);
+        }
+    }
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // set clear color to sky blue
+    glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+    float t = glfwGetTime();
+    bool first_frame = true;
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // hand over finished uploads
+        if(loader.poll() > 0 && int(chunks.size()) == chunkcount)
+            std::cout << "all chunks ready after " << (glfwGetTime()-start_time)*1.e3 << " ms" << std::endl;
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // set uniforms
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1i(detail_location, 0);
+        glUniform1i(textured_location, detail_texture != 0);
+
+        // bind texture to texture unit 0
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, detail_texture);
+
+        for(size_t i = 0;i<chunks.size();++i) {
+            // frustum culling
+            glm::vec4 projected = ViewProjection*glm::vec4(chunks[i].center,1);
+            if( (glm::distance(chunks[i].center,position) > chunksize) &&
+                (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize))
+                continue;
+
+            // draw chunk
+            glBindVertexArray(chunks[i].vao);
+            glDrawElements(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, (char*)0 + chunks[i].indexoffset);
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        if(first_frame) {
+            std::cout << "first frame after " << (glfwGetTime()-start_time)*1.e3 << " ms" << std::endl;
+            first_frame = false;
+        }
+    }
+
+    // stop the loader before deleting the objects
+    loader.stop();
+
+    // delete the created objects
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+    }
+
+    glDeleteTextures(1, &detail_texture);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
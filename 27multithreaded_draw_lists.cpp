@@ -0,0 +1,674 @@
+/* OpenGL example code - multithreaded draw lists
+ *
+ * This example renders the voxel landscape from the queries example
+ * split into many small chunks. The per chunk work (frustum culling
+ * against the six planes of the view frustum and building the sort
+ * key) is distributed over a pool of worker threads. Each worker
+ * records compact draw packets into its own command buffer and sorts
+ * it. The sorted buffers are then merged and replayed on the GL thread
+ * which only changes program, vertex array and uniform state when the
+ * value actually differs from the previous packet.
+ * The sort key puts the program in the highest bits followed by the
+ * quantized distance so packets are grouped by program and drawn front
+ * to back within a program.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ * select the number of worker threads with 1-8
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdint>
+
+// a single recorded draw
+struct DrawPacket {
+    uint64_t key;
+    int program;
+    GLuint vao;
+    GLsizei count;
+    glm::vec4 tint;
+
+    bool operator<(const DrawPacket &other) const { return key < other.key; }
+};
+
+// packets recorded by a single thread, no locking required
+class CommandBuffer {
+public:
+    void clear() { packets.clear(); }
+
+    void draw(uint64_t key, int program, GLuint vao, GLsizei count, const glm::vec4 &tint) {
+        DrawPacket packet = {key, program, vao, count, tint};
+        packets.push_back(packet);
+    }
+
+    void sort() { std::sort(packets.begin(), packets.end()); }
+
+    std::vector<DrawPacket> packets;
+};
+
+// fixed set of worker threads that execute the same job with
+// different indices, run blocks until all workers are done
+class WorkerPool {
+public:
+    WorkerPool(int count) : job_count(0), remaining(0), generation(0), running(true) {
+        for(int i = 0;i<count;++i)
+            threads.push_back(std::thread(&WorkerPool::work, this, i));
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            start.notify_all();
+        }
+        for(size_t i = 0;i<threads.size();++i)
+            threads[i].join();
+    }
+
+    int size() const { return threads.size(); }
+
+    void run(const std::function<void(int)> &function, int count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        job = function;
+        job_count = count;
+        remaining = count;
+        ++generation;
+        start.notify_all();
+        while(remaining > 0)
+            done.wait(lock);
+    }
+
+private:
+    void work(int index) {
+        unsigned seen = 0;
+        while(true) {
+            std::function<void(int)> current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(running && generation == seen)
+                    start.wait(lock);
+                if(!running)
+                    return;
+                seen = generation;
+                if(index >= job_count)
+                    continue;
+                current = job;
+            }
+
+            current(index);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--remaining == 0)
+                done.notify_one();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable start, done;
+    std::function<void(int)> job;
+    int job_count;
+    int remaining;
+    unsigned generation;
+    bool running;
+};
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    int quadcount;
+    glm::vec3 center;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// extract the frustum planes from a ViewProjection matrix
+void frustum_planes(const glm::mat4 &ViewProjection, glm::vec4 planes[6]) {
+    glm::mat4 m = glm::transpose(ViewProjection);
+    planes[0] = m[3] + m[0];
+    planes[1] = m[3] - m[0];
+    planes[2] = m[3] + m[1];
+    planes[3] = m[3] - m[1];
+    planes[4] = m[3] + m[2];
+    planes[5] = m[3] - m[2];
+}
+
+// test a chunk's bounding box against the frustum planes
+bool box_visible(const glm::vec4 planes[6], glm::vec3 center, float halfsize) {
+    for(int i = 0;i<6;++i) {
+        glm::vec3 normal(planes[i]);
+        float radius = halfsize*(std::abs(normal.x)+std::abs(normal.y)+std::abs(normal.z));
+        if(glm::dot(normal, center) + planes[i].w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "27multithreaded_draw_lists", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // draw shader
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "out vec3 fposition;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   fposition = vposition.xyz;\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    // two materials, the second one adds a height dependent gradient
+    std::string fragment_sources[2] = {
+        "#version 330\n"
+        "uniform vec4 tint;\n"
+        "in vec4 fcolor;\n"
+        "in vec3 fposition;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = tint*abs(fcolor);\n"
+        "}\n",
+
+        "#version 330\n"
+        "uniform vec4 tint;\n"
+        "in vec4 fcolor;\n"
+        "in vec3 fposition;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   float gradient = clamp(0.5+fposition.y/128.0, 0.0, 1.0);\n"
+        "   FragColor = mix(vec4(1), tint, gradient)*abs(fcolor);\n"
+        "}\n"
+    };
+
+    // program and shader handles
+    const int programcount = 2;
+    GLuint shader_programs[programcount], vertex_shader, fragment_shaders[programcount];
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    GLint ViewProjection_locations[programcount], tint_locations[programcount];
+    for(int i = 0;i<programcount;++i) {
+        // create and compiler fragment shader
+        fragment_shaders[i] = glCreateShader(GL_FRAGMENT_SHADER);
+        source = fragment_sources[i].c_str();
+        length = fragment_sources[i].size();
+        glShaderSource(fragment_shaders[i], 1, &source, &length);
+        glCompileShader(fragment_shaders[i]);
+        if(!check_shader_compile_status(fragment_shaders[i])) {
+            glfwDestroyWindow(window);
+            glfwTerminate();
+            return 1;
+        }
+
+        // create program
+        shader_programs[i] = glCreateProgram();
+
+        // attach shaders
+        glAttachShader(shader_programs[i], vertex_shader);
+        glAttachShader(shader_programs[i], fragment_shaders[i]);
+
+        // link the program and check for errors
+        glLinkProgram(shader_programs[i]);
+        check_program_link_status(shader_programs[i]);
+
+        // obtain location of uniforms
+        ViewProjection_locations[i] = glGetUniformLocation(shader_programs[i], "ViewProjection");
+        tint_locations[i] = glGetUniformLocation(shader_programs[i], "tint");
+    }
+
+    // chunk container and chunk parameters, smaller chunks than in the
+    // queries example to get more draw packets
+    std::vector<Chunk> chunks;
+    int chunkrange = 8;
+    int chunksize = 16;
+
+    // chunk extraction
+    std::cout << "generating chunks, this may take a while." << std::endl;
+
+    // iterate over all chunks we want to extract
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        generate_chunk(offset, chunksize, vertexData);
+
+        // skip empty chunks
+        if(vertexData.empty())
+            continue;
+
+        // generate and bind the vao
+        glGenVertexArrays(1, &chunk.vao);
+        glBindVertexArray(chunk.vao);
+
+        // generate and bind the vertex buffer object
+        glGenBuffers(1, &chunk.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+        // upload
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), &vertexData[0], GL_STATIC_DRAW);
+
+        // set up generic attrib pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+        // generate and bind the index buffer object
+        glGenBuffers(1, &chunk.ibo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo);
+
+        chunk.quadcount = vertexData.size()/8;
+        std::vector<GLuint> indexData(6*chunk.quadcount);
+        for(int i = 0;i<chunk.quadcount;++i) {
+            indexData[6*i + 0] = 4*i + 0;
+            indexData[6*i + 1] = 4*i + 1;
+            indexData[6*i + 2] = 4*i + 2;
+            indexData[6*i + 3] = 4*i + 2;
+            indexData[6*i + 4] = 4*i + 1;
+            indexData[6*i + 5] = 4*i + 3;
+        }
+
+        // upload
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), &indexData[0], GL_STATIC_DRAW);
+
+        // set the center location of the chunk
+        chunk.center = offset + 0.5f*chunksize - 0.5f;
+
+        // add to container
+        chunks.push_back(chunk);
+    }
+    std::cout << chunks.size() << " non empty chunks" << std::endl;
+
+    // worker threads and one command buffer per worker
+    int maxthreads = std::max(1u, std::min(8u, std::thread::hardware_concurrency()));
+    WorkerPool pool(maxthreads);
+    std::vector<CommandBuffer> buffers(maxthreads);
+    std::vector<DrawPacket> merged;
+    int threadcount = maxthreads;
+    std::cout << "using up to " << maxthreads << " threads" << std::endl;
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // set clear color to sky blue
+    glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    // accumulated timings, printed every 60 frames
+    double record_time = 0, merge_time = 0, replay_time = 0;
+    int timed_frames = 0;
+
+    float t = glfwGetTime();
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // select the number of threads
+        for(int i = 0;i<maxthreads;++i) {
+            if(glfwGetKey(window, GLFW_KEY_1+i) && threadcount != i+1) {
+                threadcount = i+1;
+                std::cout << "using " << threadcount << " threads" << std::endl;
+            }
+        }
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        glm::vec4 planes[6];
+        frustum_planes(ViewProjection, planes);
+
+        double record_start = glfwGetTime();
+
+        // record draw packets in parallel, every worker handles a
+        // contiguous range of chunks
+        pool.run([&](int index) {
+            CommandBuffer &buffer = buffers[index];
+            buffer.clear();
+            size_t begin = chunks.size()*index/threadcount;
+            size_t end = chunks.size()*(index+1)/threadcount;
+            for(size_t i = begin;i<end;++i) {
+                const Chunk &chunk = chunks[i];
+                if(!box_visible(planes, chunk.center, 0.5f*chunksize))
+                    continue;
+
+                // the chunks above the ground use the second material
+                int program = chunk.center.y > 0.0f ? 1 : 0;
+                glm::vec4 tint = program == 1 ? glm::vec4(0.6f, 0.9f, 0.5f, 1.0f) : glm::vec4(1.0f);
+
+                // 24 bit distance, 32 bit chunk index as tie breaker
+                float distance = std::min(glm::distance(position, chunk.center)/400.0f, 1.0f);
+                uint64_t key = (uint64_t(program) << 56) |
+                               (uint64_t(distance*0xffffff) << 32) |
+                               uint64_t(i);
+                buffer.draw(key, program, chunk.vao, 6*chunk.quadcount, tint);
+            }
+            buffer.sort();
+        }, threadcount);
+
+        double merge_start = glfwGetTime();
+
+        // merge the sorted buffers
+        merged.clear();
+        for(int i = 0;i<threadcount;++i) {
+            size_t middle = merged.size();
+            merged.insert(merged.end(), buffers[i].packets.begin(), buffers[i].packets.end());
+            std::inplace_merge(merged.begin(), merged.begin()+middle, merged.end());
+        }
+
+        double replay_start = glfwGetTime();
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // the matrix is the same for all programs
+        for(int i = 0;i<programcount;++i) {
+            glUseProgram(shader_programs[i]);
+            glUniformMatrix4fv(ViewProjection_locations[i], 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        }
+
+        // replay the packets and only change state when it differs
+        int current_program = -1;
+        glm::vec4 current_tint(-1.0f);
+        GLuint current_vao = 0;
+        int statechanges = 0;
+        for(size_t i = 0;i<merged.size();++i) {
+            const DrawPacket &packet = merged[i];
+            if(packet.program != current_program) {
+                current_program = packet.program;
+                glUseProgram(shader_programs[current_program]);
+                current_tint = glm::vec4(-1.0f);
+                ++statechanges;
+            }
+            if(packet.tint != current_tint) {
+                current_tint = packet.tint;
+                glUniform4fv(tint_locations[current_program], 1, glm::value_ptr(current_tint));
+                ++statechanges;
+            }
+            if(packet.vao != current_vao) {
+                current_vao = packet.vao;
+                glBindVertexArray(current_vao);
+                ++statechanges;
+            }
+            glDrawElements(GL_TRIANGLES, packet.count, GL_UNSIGNED_INT, 0);
+        }
+
+        double replay_end = glfwGetTime();
+        record_time += merge_start - record_start;
+        merge_time += replay_start - merge_start;
+        replay_time += replay_end - replay_start;
+
+        if(++timed_frames == 60) {
+            std::cout << threadcount << " threads, " << merged.size() << " packets, "
+                      << statechanges << " state changes: "
+                      << record_time/timed_frames*1.e3 << " ms record "
+                      << merge_time/timed_frames*1.e3 << " ms merge "
+                      << replay_time/timed_frames*1.e3 << " ms replay" << std::endl;
+            record_time = merge_time = replay_time = 0;
+            timed_frames = 0;
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+        glDeleteBuffers(1, &chunks[i].ibo);
+    }
+
+    for(int i = 0;i<programcount;++i) {
+        glDetachShader(shader_programs[i], vertex_shader);
+        glDetachShader(shader_programs[i], fragment_shaders[i]);
+        glDeleteShader(fragment_shaders[i]);
+        glDeleteProgram(shader_programs[i]);
+    }
+    glDeleteShader(vertex_shader);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
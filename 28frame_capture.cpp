@@ -0,0 +1,733 @@
+/* OpenGL example code - frame capture
+ *
+ * render the cube grid to a framebuffer object and capture every frame
+ * without stalling the pipeline. The pixels are read into a ring of
+ * pixel pack buffers with glReadPixels which returns immediately. A
+ * fence is placed after every read and the buffer is only mapped a
+ * few frames later when the fence has signaled. The mapped pixels are
+ * copied into a frame from a fixed pool and handed to an encoder
+ * thread which writes either a raw Y4M video or a PNG sequence. The
+ * time spent on capturing on the render thread is printed relative
+ * to the frame time.
+ *
+ * usage: 28frame_capture [--headless] [--frames N] [output.y4m | prefix.png]
+ * the default output is capture.y4m. A PNG output writes prefix_00000.png,
+ * prefix_00001.png etc. In headless mode the window stays hidden and
+ * the example exits after N (default 300) frames.
+ *
+ * toggle capturing with space (when not headless)
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// crc32 as used by the png chunks
+unsigned long png_crc32(const unsigned char *data, size_t size, unsigned long crc = 0) {
+    static unsigned long table[256];
+    static bool initialized = false;
+    if(!initialized) {
+        for(unsigned long n = 0;n<256;++n) {
+            unsigned long c = n;
+            for(int k = 0;k<8;++k)
+                c = (c&1) ? 0xedb88320ul^(c>>1) : c>>1;
+            table[n] = c;
+        }
+        initialized = true;
+    }
+    crc = crc^0xfffffffful;
+    for(size_t i = 0;i<size;++i)
+        crc = table[(crc^data[i])&0xff]^(crc>>8);
+    return crc^0xfffffffful;
+}
+
+void append_u32(std::vector<unsigned char> &out, unsigned long value) {
+    out.push_back((value>>24)&0xff);
+    out.push_back((value>>16)&0xff);
+    out.push_back((value>>8)&0xff);
+    out.push_back(value&0xff);
+}
+
+void write_png_chunk(std::ofstream &out, const char *type, const std::vector<unsigned char> &data) {
+    std::vector<unsigned char> chunk(type, type+4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    std::vector<unsigned char> header;
+    append_u32(header, data.size());
+    std::vector<unsigned char> footer;
+    append_u32(footer, png_crc32(&chunk[0], chunk.size()));
+    out.write(reinterpret_cast<const char*>(&header[0]), header.size());
+    out.write(reinterpret_cast<const char*>(&chunk[0]), chunk.size());
+    out.write(reinterpret_cast<const char*>(&footer[0]), footer.size());
+}
+
+// write an RGBA image as png. The image data is stored with
+// uncompressed deflate blocks so no zlib is required, the files are
+// large but writing them is fast. The rows are flipped since GL
+// images start at the bottom.
+bool write_png(const std::string &filename, const unsigned char *pixels, int width, int height) {
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if(!out)
+        return false;
+
+    const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+
+    // 8 bit RGBA, no interlacing
+    std::vector<unsigned char> ihdr;
+    append_u32(ihdr, width);
+    append_u32(ihdr, height);
+    const unsigned char ihdr_tail[5] = {8, 6, 0, 0, 0};
+    ihdr.insert(ihdr.end(), ihdr_tail, ihdr_tail+5);
+    write_png_chunk(out, "IHDR", ihdr);
+
+    // scanlines with filter type 0 in front of each row
+    size_t rowsize = 4*width;
+    std::vector<unsigned char> raw((rowsize+1)*height);
+    for(int y = 0;y<height;++y) {
+        raw[y*(rowsize+1)] = 0;
+        std::memcpy(&raw[y*(rowsize+1)+1], pixels + (height-1-y)*rowsize, rowsize);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<unsigned char> idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    unsigned long a = 1, b = 0;
+    for(size_t offset = 0;offset<raw.size();) {
+        size_t size = std::min<size_t>(65535, raw.size()-offset);
+        idat.push_back(offset+size == raw.size() ? 1 : 0);
+        idat.push_back(size&0xff);
+        idat.push_back((size>>8)&0xff);
+        idat.push_back(~size&0xff);
+        idat.push_back((~size>>8)&0xff);
+        idat.insert(idat.end(), raw.begin()+offset, raw.begin()+offset+size);
+        for(size_t i = offset;i<offset+size;++i) {
+            a = (a + raw[i])%65521;
+            b = (b + a)%65521;
+        }
+        offset += size;
+    }
+    append_u32(idat, (b<<16)|a);
+    write_png_chunk(out, "IDAT", idat);
+
+    write_png_chunk(out, "IEND", std::vector<unsigned char>());
+    return !out.fail();
+}
+
+// append an RGBA image as a Y4M frame, converts to 4:2:0 with full
+// range BT.601 coefficients
+void write_y4m_frame(std::ofstream &out, const unsigned char *pixels, int width, int height, std::vector<unsigned char> &yuv) {
+    int cw = width/2, ch = height/2;
+    yuv.resize(width*height + 2*cw*ch);
+    unsigned char *Y = &yuv[0];
+    unsigned char *U = Y + width*height;
+    unsigned char *V = U + cw*ch;
+    for(int y = 0;y<height;++y) {
+        const unsigned char *row = pixels + 4*width*(height-1-y);
+        for(int x = 0;x<width;++x) {
+            float r = row[4*x+0], g = row[4*x+1], b = row[4*x+2];
+            Y[y*width+x] = static_cast<unsigned char>(0.299f*r + 0.587f*g + 0.114f*b + 0.5f);
+        }
+    }
+    for(int y = 0;y<ch;++y) {
+        for(int x = 0;x<cw;++x) {
+            // average the 2x2 block
+            float r = 0, g = 0, b = 0;
+            for(int j = 0;j<2;++j)
+                for(int i = 0;i<2;++i) {
+                    const unsigned char *p = pixels + 4*(width*(height-1-(2*y+j)) + 2*x+i);
+                    r += 0.25f*p[0]; g += 0.25f*p[1]; b += 0.25f*p[2];
+                }
+            U[y*cw+x] = static_cast<unsigned char>(128.0f - 0.168736f*r - 0.331264f*g + 0.5f*b + 0.5f);
+            V[y*cw+x] = static_cast<unsigned char>(128.0f + 0.5f*r - 0.418688f*g - 0.081312f*b + 0.5f);
+        }
+    }
+    out << "FRAME\n";
+    out.write(reinterpret_cast<const char*>(&yuv[0]), yuv.size());
+}
+
+// encoder thread with a fixed pool of frames. The render thread
+// acquires a free frame, fills it and submits it. If the encoder
+// falls behind acquire blocks instead of dropping frames.
+class FrameEncoder {
+public:
+    FrameEncoder(const std::string &output, int width, int height, int poolsize)
+        : output(output), width(width), height(height), running(true), failed(false) {
+        png = output.size() > 4 && output.compare(output.size()-4, 4, ".png") == 0;
+        if(png) {
+            prefix = output.substr(0, output.size()-4);
+        } else {
+            y4m.open(output.c_str(), std::ios::binary);
+            y4m << "YUV4MPEG2 W" << width << " H" << height << " F60:1 Ip A1:1 C420jpeg\n";
+            failed = y4m.fail();
+        }
+        frames.resize(poolsize);
+        for(int i = 0;i<poolsize;++i) {
+            frames[i].resize(4*width*height);
+            free_frames.push_back(i);
+        }
+        thread = std::thread(&FrameEncoder::run, this);
+    }
+
+    ~FrameEncoder() {
+        finish();
+    }
+
+    // writes the queued frames and stops the encoder thread, returns
+    // false if any frame couldn't be written
+    bool finish() {
+        if(thread.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                running = false;
+                condition.notify_all();
+            }
+            thread.join();
+        }
+        return !failed;
+    }
+
+    bool ok() const { return !failed; }
+
+    // returns the index of a free frame
+    int acquire() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(free_frames.empty())
+            condition.wait(lock);
+        int index = free_frames.front();
+        free_frames.pop_front();
+        return index;
+    }
+
+    unsigned char* data(int index) { return &frames[index][0]; }
+
+    // returns false once the encoder failed to write a frame
+    bool submit(int index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        full_frames.push_back(index);
+        condition.notify_all();
+        return !failed;
+    }
+
+private:
+    void run() {
+        std::vector<unsigned char> yuv;
+        int written = 0;
+        while(true) {
+            int index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(running && full_frames.empty())
+                    condition.wait(lock);
+                // finish the queued frames before exiting
+                if(full_frames.empty())
+                    break;
+                index = full_frames.front();
+                full_frames.pop_front();
+            }
+
+            // after an error the frames are only recycled so the render
+            // thread doesn't block in acquire
+            if(!failed) {
+                bool ok;
+                if(png) {
+                    std::ostringstream name;
+                    name << prefix << "_" << std::setw(5) << std::setfill('0') << written << ".png";
+                    ok = write_png(name.str(), &frames[index][0], width, height);
+                } else {
+                    write_y4m_frame(y4m, &frames[index][0], width, height, yuv);
+                    ok = bool(y4m.flush());
+                }
+                if(ok)
+                    ++written;
+                else
+                    failed = true;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            free_frames.push_back(index);
+            condition.notify_all();
+        }
+        std::cout << "wrote " << written << " frames to " << output << std::endl;
+    }
+
+    std::string output, prefix;
+    int width, height;
+    bool png;
+    std::ofstream y4m;
+    std::vector<std::vector<unsigned char> > frames;
+    std::deque<int> free_frames, full_frames;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool running;
+    std::atomic<bool> failed;
+};
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+int main(int argc, char *argv[]) {
+    int width = 640;
+    int height = 480;
+
+    // parse the command line
+    bool headless = false;
+    int maxframes = 300;
+    std::string output = "capture.y4m";
+    for(int i = 1;i<argc;++i) {
+        std::string arg = argv[i];
+        if(arg == "--headless")
+            headless = true;
+        else if(arg == "--frames" && i+1 < argc)
+            maxframes = std::atoi(argv[++i]);
+        else
+            output = arg;
+    }
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // in headless mode the window is only used for the context
+    if(headless)
+        glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "28frame_capture", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n" // the projection matrix uniform
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   fcolor = vcolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    // "unbind" vao
+    glBindVertexArray(0);
+
+    // color texture and depth renderbuffer for the framebuffer, the
+    // frames are always rendered offscreen so capturing doesn't
+    // depend on the window being visible
+    GLuint texture, rbf, fbo;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    glGenRenderbuffers(1, &rbf);
+    glBindRenderbuffer(GL_RENDERBUFFER, rbf);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rbf);
+
+    // ring of pixel pack buffers with a fence for each of them
+    const int ringsize = 3;
+    GLuint pbos[ringsize];
+    GLsync fences[ringsize] = {0, 0, 0};
+    glGenBuffers(ringsize, pbos);
+    for(int i = 0;i<ringsize;++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4*width*height, 0, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // the encoder gets a few more frames than the ring so short hiccups
+    // in the encoder don't block the render thread
+    FrameEncoder encoder(output, width, height, 8);
+    if(!encoder.ok()) {
+        std::cerr << "failed to open " << output << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // accumulated timings, printed every 60 frames
+    double frame_time = 0, capture_time = 0;
+    int timed_frames = 0;
+
+    int frame = 0;
+    double last_frame = glfwGetTime();
+    bool capture = true;
+    bool space_down = false;
+    bool write_error = false;
+    while(!glfwWindowShouldClose(window) && (!headless || frame < maxframes)) {
+        glfwPollEvents();
+
+        // toggle capturing with space
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down)
+        {
+            capture = !capture;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // in headless mode the frames are spaced at the video frame rate
+        // so the result doesn't depend on the rendering speed
+        float t = headless ? frame/60.0f : glfwGetTime();
+
+        glEnable(GL_DEPTH_TEST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*t, glm::vec3(1.0f, 1.0f, 1.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, 8*8*8);
+
+        double capture_start = glfwGetTime();
+        int slot = frame%ringsize;
+
+        // the slot still contains the frame from ringsize frames before,
+        // hand it over before reusing the buffer. This only waits if the
+        // GPU is more than ringsize frames behind.
+        if(fences[slot]) {
+            glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(fences[slot]);
+            fences[slot] = 0;
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+            void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4*width*height, GL_MAP_READ_BIT);
+            int index = encoder.acquire();
+            std::memcpy(encoder.data(index), pixels, 4*width*height);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            if(!encoder.submit(index)) {
+                std::cerr << "failed to write " << output << ", stopping" << std::endl;
+                write_error = true;
+                break;
+            }
+        }
+
+        // start the asynchronous read of this frame
+        if(capture) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+            fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        capture_time += glfwGetTime() - capture_start;
+
+        // show the frame in the window
+        if(!headless) {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+            glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        if(!headless)
+            glfwSwapBuffers(window);
+        ++frame;
+
+        double now = glfwGetTime();
+        frame_time += now - last_frame;
+        last_frame = now;
+        if(++timed_frames == 60) {
+            std::cout << frame_time/timed_frames*1.e3 << " ms/frame, "
+                      << capture_time/timed_frames*1.e3 << " ms capture ("
+                      << 100.0*capture_time/frame_time << "%)" << std::endl;
+            frame_time = capture_time = 0;
+            timed_frames = 0;
+        }
+    }
+
+    // hand over the frames that are still in flight in order
+    for(int i = 0;i<ringsize;++i) {
+        int slot = (frame+i)%ringsize;
+        if(!fences[slot])
+            continue;
+        glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(fences[slot]);
+        fences[slot] = 0;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4*width*height, GL_MAP_READ_BIT);
+        int index = encoder.acquire();
+        std::memcpy(encoder.data(index), pixels, 4*width*height);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        encoder.submit(index);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // wait for the encoder so a failed write at the end is reported too
+    if(!encoder.finish() && !write_error) {
+        std::cerr << "failed to write " << output << std::endl;
+        write_error = true;
+    }
+
+    // delete the created objects
+
+    glDeleteBuffers(ringsize, pbos);
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &rbf);
+    glDeleteTextures(1, &texture);
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return write_error ? 1 : 0;
+}
@@ -0,0 +1,689 @@
+/* OpenGL example code - pipeline statistics
+ *
+ * renders three passes that stress different pipeline stages: a
+ * compute pass that animates particles, a geometry shader pass that
+ * expands them to billboards (like the geometry shader example) and a
+ * tessellated terrain (like the tesselation example). Each pass is
+ * wrapped in the GL_ARB_pipeline_statistics_query counters and a
+ * GL_TIME_ELAPSED query. The queries live in a pool with a ring of
+ * frames per pass and are only read back once GL_QUERY_RESULT_AVAILABLE
+ * reports them done, so the statistics never stall the pipeline.
+ * The derived ratios (geometry shader expansion, tessellation
+ * amplification, clipping rejection) are printed next to the timings.
+ *
+ * adjust the tessellation level with up/down
+ * toggle a camera inside the particle disc with space so the
+ * billboards behind it get clipped
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+// the counters we are interested in and their column names
+struct Statistic {
+    GLenum target;
+    const char *name;
+};
+
+const Statistic statistics[] = {
+    { GL_VERTICES_SUBMITTED_ARB,                 "verts" },
+    { GL_PRIMITIVES_SUBMITTED_ARB,               "prims" },
+    { GL_VERTEX_SHADER_INVOCATIONS_ARB,          "vs" },
+    { GL_TESS_CONTROL_SHADER_PATCHES_ARB,        "tcs" },
+    { GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB, "tes" },
+    { GL_GEOMETRY_SHADER_INVOCATIONS,            "gs" },
+    { GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED_ARB, "gs out" },
+    { GL_CLIPPING_INPUT_PRIMITIVES_ARB,          "clip in" },
+    { GL_CLIPPING_OUTPUT_PRIMITIVES_ARB,         "clip out" },
+    { GL_FRAGMENT_SHADER_INVOCATIONS_ARB,        "fs" },
+    { GL_COMPUTE_SHADER_INVOCATIONS_ARB,         "cs" },
+};
+const int statisticcount = sizeof(statistics)/sizeof(statistics[0]);
+
+// indices into the result arrays
+enum {
+    VERTICES, PRIMITIVES, VS, TCS, TES, GS, GS_OUT, CLIP_IN, CLIP_OUT, FS, CS,
+    TIME // the GL_TIME_ELAPSED query is stored after the statistics
+};
+
+// pool of queries with one set of statistics + timer per pass and
+// frame. results are collected from the oldest frame in the ring
+// and only if the gpu has already finished it.
+class QueryPool {
+public:
+    QueryPool(int passcount, int framecount)
+    : passes(passcount), frames(framecount), current(0), queries(passcount*framecount*(statisticcount+1)),
+      issued(framecount, false)
+    {
+        glGenQueries(queries.size(), &queries[0]);
+    }
+
+    ~QueryPool()
+    {
+        glDeleteQueries(queries.size(), &queries[0]);
+    }
+
+    // advance to the next frame in the ring
+    void next_frame()
+    {
+        current = (current+1)%frames;
+        issued[current] = false;
+    }
+
+    void begin(int pass)
+    {
+        GLuint *set = query_set(current, pass);
+        for(int i = 0;i<statisticcount;++i)
+            glBeginQuery(statistics[i].target, set[i]);
+        glBeginQuery(GL_TIME_ELAPSED, set[TIME]);
+    }
+
+    void end()
+    {
+        for(int i = 0;i<statisticcount;++i)
+            glEndQuery(statistics[i].target);
+        glEndQuery(GL_TIME_ELAPSED);
+        issued[current] = true;
+    }
+
+    // read the results of the oldest frame if they are available.
+    // values has to hold passes*(statisticcount+1) entries
+    bool collect(GLuint64 *values)
+    {
+        int oldest = (current+1)%frames;
+        if(!issued[oldest])
+            return false;
+
+        // the last query of the frame being done implies all are
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query_set(oldest, passes-1)[TIME], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE)
+            return false;
+
+        for(int pass = 0;pass<passes;++pass)
+        {
+            GLuint *set = query_set(oldest, pass);
+            for(int i = 0;i<=statisticcount;++i)
+                glGetQueryObjectui64v(set[i], GL_QUERY_RESULT, &values[pass*(statisticcount+1)+i]);
+        }
+        issued[oldest] = false;
+        return true;
+    }
+
+private:
+    GLuint* query_set(int frame, int pass)
+    {
+        return &queries[(frame*passes+pass)*(statisticcount+1)];
+    }
+
+    int passes, frames, current;
+    std::vector<GLuint> queries;
+    std::vector<bool> issued;
+};
+
+// ratio helper that doesn't divide by zero for unused stages
+double ratio(GLuint64 a, GLuint64 b) {
+    return b==0?0.0:double(a)/double(b);
+}
+
+bool has_extension(const char *name) {
+    GLint count;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0;i<count;++i)
+        if(std::strcmp(name, reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))) == 0)
+            return true;
+    return false;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "29pipeline_statistics", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    if(!has_extension("GL_ARB_pipeline_statistics_query")) {
+        std::cerr << "GL_ARB_pipeline_statistics_query is not supported" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // the compute shader rotates the particles around the y axis
+    // with the angular velocity falling off with the radius
+    std::string compute_source =
+        "#version 430\n"
+        "layout(local_size_x = 256) in;\n"
+        "uniform float dt;\n"
+        "uniform uint count;\n"
+        "layout(std430, binding = 0) buffer pblock { vec4 positions[]; };\n"
+        "void main() {\n"
+        "   uint index = gl_GlobalInvocationID.x;\n"
+        "   if(index >= count) return;\n"
+        "   vec4 p = positions[index];\n"
+        "   float angle = dt/(0.5+0.1*length(p.xz));\n"
+        "   float c = cos(angle), s = sin(angle);\n"
+        "   positions[index] = vec4(c*p.x-s*p.z, p.y, s*p.x+c*p.z, 1);\n"
+        "}\n";
+
+    // the particle shaders are the ones from the geometry shader example
+    std::string particle_vertex_source =
+        "#version 330\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "void main() {\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    std::string particle_geometry_source =
+        "#version 330\n"
+        "uniform mat4 View;\n"
+        "uniform mat4 Projection;\n"
+        "layout (points) in;\n"
+        "layout (triangle_strip, max_vertices = 4) out;\n"
+        "out vec2 txcoord;\n"
+        "void main() {\n"
+        "   vec4 pos = View*gl_in[0].gl_Position;\n"
+        "   txcoord = vec2(-1,-1);\n"
+        "   gl_Position = Projection*(pos+0.3*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1,-1);\n"
+        "   gl_Position = Projection*(pos+0.3*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2(-1, 1);\n"
+        "   gl_Position = Projection*(pos+0.3*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1, 1);\n"
+        "   gl_Position = Projection*(pos+0.3*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "}\n";
+
+    std::string particle_fragment_source =
+        "#version 330\n"
+        "in vec2 txcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   float s = 0.2*(1/(1+15.*dot(txcoord, txcoord))-1/16.);\n"
+        "   FragColor = s*vec4(1,0.9,0.6,1);\n"
+        "}\n";
+
+    // the terrain is a grid of quad patches generated from the
+    // VertexID and InstanceID and displaced in the evaluation shader
+    std::string terrain_vertex_source =
+        "#version 400\n"
+        "uniform uint gridsize;\n"
+        "void main() {\n"
+        "   vec2 corner = vec2(gl_VertexID%2, gl_VertexID/2);\n"
+        "   vec2 patch = vec2(gl_InstanceID%gridsize, gl_InstanceID/gridsize);\n"
+        "   vec2 pos = 24.0*((patch+corner)/float(gridsize)-0.5);\n"
+        "   gl_Position = vec4(pos.x, -4, pos.y, 1);\n"
+        "}\n";
+
+    std::string tess_control_source =
+        "#version 400\n"
+        "uniform float tess_level;\n"
+        "layout(vertices = 4) out;\n"
+        "void main() {\n"
+        "   if(gl_InvocationID == 0) {\n"
+        "       gl_TessLevelOuter[0] = tess_level;\n"
+        "       gl_TessLevelOuter[1] = tess_level;\n"
+        "       gl_TessLevelOuter[2] = tess_level;\n"
+        "       gl_TessLevelOuter[3] = tess_level;\n"
+        "       gl_TessLevelInner[0] = tess_level;\n"
+        "       gl_TessLevelInner[1] = tess_level;\n"
+        "   }\n"
+        "   gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;\n"
+        "}\n";
+
+    std::string tess_eval_source =
+        "#version 400\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(quads, equal_spacing, ccw) in;\n"
+        "out float height;\n"
+        "void main() {\n"
+        "   vec4 a = mix(gl_in[0].gl_Position, gl_in[1].gl_Position, gl_TessCoord.x);\n"
+        "   vec4 b = mix(gl_in[2].gl_Position, gl_in[3].gl_Position, gl_TessCoord.x);\n"
+        "   vec4 pos = mix(a, b, gl_TessCoord.y);\n"
+        "   height = 0.5+0.25*(sin(0.7*pos.x)*cos(0.5*pos.z)+0.5*sin(1.9*pos.x+1.3*pos.z));\n"
+        "   pos.y += 2.0*height;\n"
+        "   gl_Position = ViewProjection*pos;\n"
+        "}\n";
+
+    std::string terrain_fragment_source =
+        "#version 400\n"
+        "in float height;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(mix(vec3(0.1,0.2,0.1), vec3(0.5,0.45,0.4), height), 1);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint compute_program, compute_shader;
+    GLuint particle_program, particle_vertex_shader, particle_geometry_shader, particle_fragment_shader;
+    GLuint terrain_program, terrain_vertex_shader, tess_control_shader, tess_eval_shader, terrain_fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler compute shader
+    compute_shader = glCreateShader(GL_COMPUTE_SHADER);
+    source = compute_source.c_str();
+    length = compute_source.size();
+    glShaderSource(compute_shader, 1, &source, &length);
+    glCompileShader(compute_shader);
+    if(!check_shader_compile_status(compute_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    compute_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(compute_program, compute_shader);
+
+    // link the program and check for errors
+    glLinkProgram(compute_program);
+    check_program_link_status(compute_program);
+
+    GLint dt_location = glGetUniformLocation(compute_program, "dt");
+    GLint count_location = glGetUniformLocation(compute_program, "count");
+
+    // create and compiler particle vertex shader
+    particle_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = particle_vertex_source.c_str();
+    length = particle_vertex_source.size();
+    glShaderSource(particle_vertex_shader, 1, &source, &length);
+    glCompileShader(particle_vertex_shader);
+    if(!check_shader_compile_status(particle_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler particle geometry shader
+    particle_geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
+    source = particle_geometry_source.c_str();
+    length = particle_geometry_source.size();
+    glShaderSource(particle_geometry_shader, 1, &source, &length);
+    glCompileShader(particle_geometry_shader);
+    if(!check_shader_compile_status(particle_geometry_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler particle fragment shader
+    particle_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = particle_fragment_source.c_str();
+    length = particle_fragment_source.size();
+    glShaderSource(particle_fragment_shader, 1, &source, &length);
+    glCompileShader(particle_fragment_shader);
+    if(!check_shader_compile_status(particle_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    particle_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(particle_program, particle_vertex_shader);
+    glAttachShader(particle_program, particle_geometry_shader);
+    glAttachShader(particle_program, particle_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(particle_program);
+    check_program_link_status(particle_program);
+
+    GLint View_location = glGetUniformLocation(particle_program, "View");
+    GLint Projection_location = glGetUniformLocation(particle_program, "Projection");
+
+    // create and compiler terrain vertex shader
+    terrain_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = terrain_vertex_source.c_str();
+    length = terrain_vertex_source.size();
+    glShaderSource(terrain_vertex_shader, 1, &source, &length);
+    glCompileShader(terrain_vertex_shader);
+    if(!check_shader_compile_status(terrain_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler tesselation control shader
+    tess_control_shader = glCreateShader(GL_TESS_CONTROL_SHADER);
+    source = tess_control_source.c_str();
+    length = tess_control_source.size();
+    glShaderSource(tess_control_shader, 1, &source, &length);
+    glCompileShader(tess_control_shader);
+    if(!check_shader_compile_status(tess_control_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler tesselation evaluation shader
+    tess_eval_shader = glCreateShader(GL_TESS_EVALUATION_SHADER);
+    source = tess_eval_source.c_str();
+    length = tess_eval_source.size();
+    glShaderSource(tess_eval_shader, 1, &source, &length);
+    glCompileShader(tess_eval_shader);
+    if(!check_shader_compile_status(tess_eval_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler terrain fragment shader
+    terrain_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = terrain_fragment_source.c_str();
+    length = terrain_fragment_source.size();
+    glShaderSource(terrain_fragment_shader, 1, &source, &length);
+    glCompileShader(terrain_fragment_shader);
+    if(!check_shader_compile_status(terrain_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    terrain_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(terrain_program, terrain_vertex_shader);
+    glAttachShader(terrain_program, tess_control_shader);
+    glAttachShader(terrain_program, tess_eval_shader);
+    glAttachShader(terrain_program, terrain_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(terrain_program);
+    check_program_link_status(terrain_program);
+
+    GLint ViewProjection_location = glGetUniformLocation(terrain_program, "ViewProjection");
+    GLint gridsize_location = glGetUniformLocation(terrain_program, "gridsize");
+    GLint tess_level_location = glGetUniformLocation(terrain_program, "tess_level");
+
+    // vao and vbo handle
+    GLuint particle_vao, particle_vbo, terrain_vao;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &particle_vao);
+    glBindVertexArray(particle_vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &particle_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, particle_vbo);
+
+    const int particles = 64*1024;
+
+    // create a disc of particles. these are vec4 so the
+    // compute shader can use them as std430 array
+    std::vector<GLfloat> vertexData(particles*4);
+    for(int i = 0;i<particles;++i)
+    {
+        float alpha = 2.0f*3.1416f*(std::rand()/float(RAND_MAX));
+        float r = 10.0f*std::sqrt(std::rand()/float(RAND_MAX));
+        vertexData[4*i+0] = r*std::sin(alpha);
+        vertexData[4*i+1] = 0.5f*(std::rand()/float(RAND_MAX)-0.5f);
+        vertexData[4*i+2] = r*std::cos(alpha);
+        vertexData[4*i+3] = 1.0f;
+    }
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*vertexData.size(), &vertexData[0], GL_DYNAMIC_COPY);
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    // the same buffer is used as storage buffer by the compute shader
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, particle_vbo);
+
+    // the terrain generates its vertices from ids so the vao is empty
+    glGenVertexArrays(1, &terrain_vao);
+
+    const int gridsize = 16;
+    glPatchParameteri(GL_PATCH_VERTICES, 4);
+
+    // one pool of queries for all passes with a few frames of latency
+    enum { COMPUTE_PASS, TERRAIN_PASS, PARTICLE_PASS, PASS_COUNT };
+    const char *pass_names[] = { "compute", "terrain", "particles" };
+    const int framelatency = 5;
+    QueryPool *pool = new QueryPool(PASS_COUNT, framelatency);
+    std::vector<GLuint64> results(PASS_COUNT*(statisticcount+1));
+
+    float tess_level = 8.0f;
+    bool behind = false;
+    bool space_down = false;
+    bool up_down = false, down_down = false;
+
+    int frame = 0;
+    float last_time = glfwGetTime();
+
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+        float dt = t-last_time;
+        last_time = t;
+
+        // toggle the camera direction
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            behind = !behind;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // change the tessellation level
+        if(glfwGetKey(window, GLFW_KEY_UP) && !up_down) {
+            tess_level = std::min(64.0f, 2.0f*tess_level);
+        }
+        up_down = glfwGetKey(window, GLFW_KEY_UP);
+        if(glfwGetKey(window, GLFW_KEY_DOWN) && !down_down) {
+            tess_level = std::max(1.0f, 0.5f*tess_level);
+        }
+        down_down = glfwGetKey(window, GLFW_KEY_DOWN);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -14.0f));
+
+        // look at the scene from above or, when looking away,
+        // from a position inside the particle disc
+        if(behind)
+            View = glm::rotate(glm::mat4(1.0f), 180.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+        else
+            View = glm::rotate(View, 35.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        pool->next_frame();
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // animate the particles
+        pool->begin(COMPUTE_PASS);
+        glUseProgram(compute_program);
+        glUniform1f(dt_location, dt);
+        glUniform1ui(count_location, particles);
+        glDispatchCompute((particles+255)/256, 1, 1);
+        pool->end();
+
+        // the vertex fetch has to see the compute shader writes
+        glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+        // draw the terrain
+        pool->begin(TERRAIN_PASS);
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_BLEND);
+        glUseProgram(terrain_program);
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1ui(gridsize_location, gridsize);
+        glUniform1f(tess_level_location, tess_level);
+        glBindVertexArray(terrain_vao);
+        glDrawArraysInstanced(GL_PATCHES, 0, 4, gridsize*gridsize);
+        pool->end();
+
+        // draw the particles blended on top
+        pool->begin(PARTICLE_PASS);
+        glEnable(GL_BLEND);
+        glDepthMask(GL_FALSE);
+        glUseProgram(particle_program);
+        glUniformMatrix4fv(View_location, 1, GL_FALSE, glm::value_ptr(View));
+        glUniformMatrix4fv(Projection_location, 1, GL_FALSE, glm::value_ptr(Projection));
+        glBindVertexArray(particle_vao);
+        glDrawArrays(GL_POINTS, 0, particles);
+        glDepthMask(GL_TRUE);
+        pool->end();
+
+        // report the statistics about once per second
+        if(pool->collect(&results[0]) && frame%60 == 0) {
+            std::cout << "tess level " << tess_level << (behind?", looking away":"") << std::endl;
+            std::cout << std::setw(10) << "pass" << std::setw(9) << "ms";
+            for(int i = 0;i<statisticcount;++i)
+                std::cout << std::setw(10) << statistics[i].name;
+            std::cout << std::endl;
+            for(int pass = 0;pass<PASS_COUNT;++pass)
+            {
+                GLuint64 *r = &results[pass*(statisticcount+1)];
+                std::cout << std::setw(10) << pass_names[pass] << std::setw(9) << std::fixed << std::setprecision(3) << r[TIME]*1.e-6;
+                for(int i = 0;i<statisticcount;++i)
+                    std::cout << std::setw(10) << r[i];
+                std::cout << std::endl;
+            }
+            GLuint64 *terrain = &results[TERRAIN_PASS*(statisticcount+1)];
+            GLuint64 *billboards = &results[PARTICLE_PASS*(statisticcount+1)];
+            std::cout << std::setprecision(2);
+            std::cout << "tessellation amplification " << ratio(terrain[TES], terrain[VS]) << "x evaluations per vertex, ";
+            std::cout << ratio(terrain[CLIP_IN], terrain[TCS]) << " triangles per patch" << std::endl;
+            std::cout << "geometry shader expansion " << ratio(billboards[GS_OUT], billboards[GS]) << " primitives per invocation, ";
+            std::cout << ratio(billboards[CLIP_IN], billboards[PRIMITIVES]) << " triangles per point" << std::endl;
+            std::cout << "clipping keeps " << 100.0*ratio(terrain[CLIP_OUT], terrain[CLIP_IN]) << "% of terrain and ";
+            std::cout << 100.0*ratio(billboards[CLIP_OUT], billboards[CLIP_IN]) << "% of particle triangles, ";
+            std::cout << ratio(billboards[FS], billboards[CLIP_OUT]) << " fragments per particle triangle" << std::endl;
+            std::cout << std::endl;
+        }
+        ++frame;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    delete pool;
+    glDeleteVertexArrays(1, &particle_vao);
+    glDeleteVertexArrays(1, &terrain_vao);
+    glDeleteBuffers(1, &particle_vbo);
+
+    glDetachShader(compute_program, compute_shader);
+    glDeleteShader(compute_shader);
+    glDeleteProgram(compute_program);
+
+    glDetachShader(particle_program, particle_vertex_shader);
+    glDetachShader(particle_program, particle_geometry_shader);
+    glDetachShader(particle_program, particle_fragment_shader);
+    glDeleteShader(particle_vertex_shader);
+    glDeleteShader(particle_geometry_shader);
+    glDeleteShader(particle_fragment_shader);
+    glDeleteProgram(particle_program);
+
+    glDetachShader(terrain_program, terrain_vertex_shader);
+    glDetachShader(terrain_program, tess_control_shader);
+    glDetachShader(terrain_program, tess_eval_shader);
+    glDetachShader(terrain_program, terrain_fragment_shader);
+    glDeleteShader(terrain_vertex_shader);
+    glDeleteShader(tess_control_shader);
+    glDeleteShader(tess_eval_shader);
+    glDeleteShader(terrain_fragment_shader);
+    glDeleteProgram(terrain_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,863 @@
+/* OpenGL example code - gpu memory accounting
+ *
+ * wraps buffer and texture allocation in a tracker that records the
+ * size of every allocation by category and label. The scene contains
+ * the typical offenders from the other examples: per chunk vertex and
+ * index buffers like in the queries example, a 1024x1024 GL_RGB32F
+ * heightfield like the one in the tesselation example, a triple
+ * buffered particle vbo and window sized render targets. The tracker
+ * reports current and peak usage per category and warns as soon as an
+ * allocation pushes the total over the budget. Where the driver exposes
+ * GL_NVX_gpu_memory_info or GL_ATI_meminfo its numbers are printed as
+ * well. The sizes are estimates, drivers add padding and alignment.
+ *
+ * the budget in MB can be given as first argument (default 64)
+ * print the report with R
+ * toggle the heightfield between GL_RGB32F and GL_RGB16F with space
+ * resizing the window reallocates the render targets
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+// these extensions are not part of the core profile headers
+#ifndef GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX 0x9047
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#define GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX 0x904A
+#define GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX 0x904B
+#endif
+
+#ifndef GL_VBO_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#define GL_TEXTURE_FREE_MEMORY_ATI 0x87FC
+#define GL_RENDERBUFFER_FREE_MEMORY_ATI 0x87FD
+#endif
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    int quadcount;
+    glm::vec3 center;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// same conservative frustum test as in the queries example
+bool outside_frustum(const Chunk &chunk, glm::vec3 position, const glm::mat4 &ViewProjection, float chunksize) {
+    glm::vec4 projected = ViewProjection*glm::vec4(chunk.center,1);
+    return (glm::distance(chunk.center,position) > chunksize) &&
+           (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize);
+}
+
+// the categories allocations are accounted to
+enum Category { GEOMETRY, TEXTURES, RENDER_TARGETS, STREAMING, CATEGORY_COUNT };
+const char *category_names[CATEGORY_COUNT] = { "geometry", "textures", "render targets", "streaming" };
+
+double megabytes(GLsizeiptr bytes) {
+    return bytes/(1024.0*1024.0);
+}
+
+// size of a texel for the internal formats used in the examples.
+// drivers usually pad three component formats to four, so they are
+// accounted with the size of the four component format
+GLsizeiptr texel_size(GLenum internalformat) {
+    switch(internalformat) {
+        case GL_R8:
+            return 1;
+        case GL_RG8: case GL_R16F:
+            return 2;
+        case GL_RGB16F: case GL_RGBA16F: case GL_RG32F:
+            return 8;
+        case GL_RGB32F: case GL_RGBA32F:
+            return 16;
+        default: // GL_RGB8, GL_RGBA8, GL_R11F_G11F_B10F, depth formats etc.
+            return 4;
+    }
+}
+
+// wrappers around buffer and texture allocation that keep track of
+// how much memory is used per category and label
+class MemoryTracker {
+public:
+    MemoryTracker(GLsizeiptr budget_bytes)
+    : budget(budget_bytes), total(0), peak(0), over_budget(false)
+    {
+        for(int i = 0;i<CATEGORY_COUNT;++i)
+            current[i] = category_peak[i] = 0;
+    }
+
+    // glBufferData with accounting. respecifying a buffer replaces
+    // its previous allocation
+    void buffer_data(GLenum target, GLuint buffer, GLsizeiptr size, const void *data, GLenum usage,
+                     Category category, const std::string &label)
+    {
+        glBindBuffer(target, buffer);
+        glBufferData(target, size, data, usage);
+        release(buffers, buffer);
+        allocate(buffers, buffer, size, category, label);
+    }
+
+    // glTexImage2D with accounting, the mip chain is generated and
+    // accounted for if requested
+    void tex_image_2d(GLuint texture, GLenum internalformat, GLsizei w, GLsizei h, GLenum format, GLenum type,
+                      const void *data, bool mipmaps, Category category, const std::string &label)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalformat, w, h, 0, format, type, data);
+        GLsizeiptr size = GLsizeiptr(w)*h*texel_size(internalformat);
+        if(mipmaps) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+            while(w>1 || h>1) {
+                w = std::max(1, w/2);
+                h = std::max(1, h/2);
+                size += GLsizeiptr(w)*h*texel_size(internalformat);
+            }
+        }
+        release(textures, texture);
+        allocate(textures, texture, size, category, label);
+    }
+
+    void delete_buffer(GLuint buffer)
+    {
+        release(buffers, buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+
+    void delete_texture(GLuint texture)
+    {
+        release(textures, texture);
+        glDeleteTextures(1, &texture);
+    }
+
+    void report() const
+    {
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "gpu memory per category (current / peak MB)" << std::endl;
+        for(int i = 0;i<CATEGORY_COUNT;++i)
+            std::cout << "  " << std::left << std::setw(16) << category_names[i] << std::right
+                      << std::setw(9) << megabytes(current[i]) << " / " << megabytes(category_peak[i]) << std::endl;
+        std::cout << "gpu memory per label (current / peak MB)" << std::endl;
+        for(LabelMap::const_iterator i = labels.begin();i!=labels.end();++i)
+            std::cout << "  " << std::left << std::setw(24) << i->first << std::right
+                      << std::setw(9) << megabytes(i->second.bytes) << " / " << megabytes(i->second.peak)
+                      << " in " << i->second.count << " objects (" << category_names[i->second.category] << ")" << std::endl;
+        std::cout << "total " << megabytes(total) << " MB, peak " << megabytes(peak) << " MB, budget "
+                  << megabytes(budget) << " MB (" << 100.0*total/budget << "% used)" << std::endl;
+    }
+
+private:
+    struct Allocation {
+        Category category;
+        std::string label;
+        GLsizeiptr bytes;
+    };
+
+    struct LabelUsage {
+        Category category;
+        GLsizeiptr bytes, peak;
+        int count;
+    };
+
+    typedef std::map<GLuint, Allocation> AllocationMap;
+    typedef std::map<std::string, LabelUsage> LabelMap;
+
+    void allocate(AllocationMap &allocations, GLuint name, GLsizeiptr bytes, Category category, const std::string &label)
+    {
+        Allocation allocation;
+        allocation.category = category;
+        allocation.label = label;
+        allocation.bytes = bytes;
+        allocations[name] = allocation;
+
+        current[category] += bytes;
+        category_peak[category] = std::max(category_peak[category], current[category]);
+        total += bytes;
+        peak = std::max(peak, total);
+
+        LabelUsage &usage = labels[label];
+        usage.category = category;
+        usage.bytes += bytes;
+        usage.peak = std::max(usage.peak, usage.bytes);
+        usage.count += 1;
+
+        // only warn when crossing the budget and not for
+        // every single allocation after that
+        if(total > budget && !over_budget) {
+            std::cerr << "warning: allocating " << megabytes(bytes) << " MB for " << label
+                      << " exceeds the budget of " << megabytes(budget) << " MB (total "
+                      << megabytes(total) << " MB)" << std::endl;
+            over_budget = true;
+        }
+    }
+
+    void release(AllocationMap &allocations, GLuint name)
+    {
+        AllocationMap::iterator i = allocations.find(name);
+        if(i == allocations.end())
+            return;
+
+        current[i->second.category] -= i->second.bytes;
+        total -= i->second.bytes;
+
+        LabelUsage &usage = labels[i->second.label];
+        usage.bytes -= i->second.bytes;
+        usage.count -= 1;
+
+        allocations.erase(i);
+        if(total <= budget)
+            over_budget = false;
+    }
+
+    GLsizeiptr budget, total, peak;
+    GLsizeiptr current[CATEGORY_COUNT], category_peak[CATEGORY_COUNT];
+    bool over_budget;
+    AllocationMap buffers, textures;
+    LabelMap labels;
+};
+
+// helper to check if an extension is supported
+bool has_extension(const char *name) {
+    GLint count;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0;i<count;++i)
+        if(std::strcmp(name, reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))) == 0)
+            return true;
+    return false;
+}
+
+// print what the driver reports if it exposes memory information,
+// the values are in KB
+void report_driver_memory() {
+    if(has_extension("GL_NVX_gpu_memory_info")) {
+        GLint dedicated, total, available, evictions, evicted;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &dedicated);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &total);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTION_COUNT_NVX, &evictions);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_EVICTED_MEMORY_NVX, &evicted);
+        std::cout << "driver: " << available/1024.0 << " MB of " << total/1024.0 << " MB available ("
+                  << dedicated/1024.0 << " MB dedicated), " << evictions << " evictions ("
+                  << evicted/1024.0 << " MB)" << std::endl;
+    } else if(has_extension("GL_ATI_meminfo")) {
+        // the first of the four values is the total free memory in the pool
+        GLint vbo[4], texture[4], renderbuffer[4];
+        glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, vbo);
+        glGetIntegerv(GL_TEXTURE_FREE_MEMORY_ATI, texture);
+        glGetIntegerv(GL_RENDERBUFFER_FREE_MEMORY_ATI, renderbuffer);
+        std::cout << "driver: free memory for buffers " << vbo[0]/1024.0 << " MB, textures "
+                  << texture[0]/1024.0 << " MB, renderbuffers " << renderbuffer[0]/1024.0 << " MB" << std::endl;
+    } else {
+        std::cout << "driver: no memory information available" << std::endl;
+    }
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    int width = 640;
+    int height = 480;
+
+    // the memory budget in MB
+    GLsizeiptr budget = 64;
+    if(argc > 1)
+        budget = std::max(1, std::atoi(argv[1]));
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "30memory_accounting", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    MemoryTracker tracker(budget*1024*1024);
+
+    // the chunk shader tints the blocks with the heightfield
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "out vec3 worldpos;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   worldpos = vposition.xyz;\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "uniform sampler2D heightfield;\n"
+        "in vec4 fcolor;\n"
+        "in vec3 worldpos;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   vec3 tint = texture(heightfield, worldpos.xz/128.0).rgb;\n"
+        "   FragColor = vec4(abs(fcolor.rgb)*(0.6+0.4*tint), 1);\n"
+        "}\n";
+
+    // the particles are plain points
+    std::string particle_vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "void main() {\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string particle_fragment_source =
+        "#version 330\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(1,1,1,1);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+    GLuint particle_program, particle_vertex_shader, particle_fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // create and compiler particle vertex shader
+    particle_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = particle_vertex_source.c_str();
+    length = particle_vertex_source.size();
+    glShaderSource(particle_vertex_shader, 1, &source, &length);
+    glCompileShader(particle_vertex_shader);
+    if(!check_shader_compile_status(particle_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler particle fragment shader
+    particle_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = particle_fragment_source.c_str();
+    length = particle_fragment_source.size();
+    glShaderSource(particle_fragment_shader, 1, &source, &length);
+    glCompileShader(particle_fragment_shader);
+    if(!check_shader_compile_status(particle_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    particle_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(particle_program, particle_vertex_shader);
+    glAttachShader(particle_program, particle_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(particle_program);
+    check_program_link_status(particle_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint heightfield_location = glGetUniformLocation(shader_program, "heightfield");
+    GLint ParticleViewProjection_location = glGetUniformLocation(particle_program, "ViewProjection");
+
+    // chunk container and chunk parameters
+    std::vector<Chunk> chunks;
+    int chunkrange = 2;
+    int chunksize = 32;
+
+    // chunk extraction
+    std::cout << "generating chunks, this may take a while." << std::endl;
+
+    // iterate over all chunks we want to extract
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+
+        // chunk data
+
+        // generate and bind the vao
+        glGenVertexArrays(1, &chunk.vao);
+        glBindVertexArray(chunk.vao);
+
+        // generate the vertex buffer object
+        glGenBuffers(1, &chunk.vbo);
+
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        float threshold = 0.0f;
+        // iterate over all blocks within the chunk
+        for(int x = 0;x<chunksize;++x) {
+            for(int y = 0;y<chunksize;++y)  {
+                for(int z = 0;z<chunksize;++z) {
+                    glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                    // insert quads if current block is solid and neighbors are not
+                    if(world_function(pos)<threshold) {
+                        if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 1, 0, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 1, 0));
+                        }
+                        if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0, 0, 1));
+                        }
+                        if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3(-1, 0, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0,-1, 0));
+                        }
+                        if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                            vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                            vertexData.push_back(glm::vec3( 0, 0,-1));
+                        }
+                    }
+                }
+            }
+        }
+        // upload
+        tracker.buffer_data(GL_ARRAY_BUFFER, chunk.vbo, sizeof(glm::vec3)*vertexData.size(),
+                            vertexData.empty()?0:&vertexData[0], GL_STATIC_DRAW, GEOMETRY, "chunk vertices");
+
+        // set up generic attrib pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+        // generate the index buffer object
+        glGenBuffers(1, &chunk.ibo);
+
+        chunk.quadcount = vertexData.size()/8;
+        std::vector<GLuint> indexData(6*chunk.quadcount);
+        for(int i = 0;i<chunk.quadcount;++i) {
+            indexData[6*i + 0] = 4*i + 0;
+            indexData[6*i + 1] = 4*i + 1;
+            indexData[6*i + 2] = 4*i + 2;
+            indexData[6*i + 3] = 4*i + 2;
+            indexData[6*i + 4] = 4*i + 1;
+            indexData[6*i + 5] = 4*i + 3;
+        }
+
+        // upload, this also binds the ibo to the vao
+        tracker.buffer_data(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo, sizeof(GLuint)*indexData.size(),
+                            indexData.empty()?0:&indexData[0], GL_STATIC_DRAW, GEOMETRY, "chunk indices");
+
+        // set the center location of the chunk
+        chunk.center = offset + 0.5f*chunksize;
+
+        // add to container
+        chunks.push_back(chunk);
+    }
+
+    // create a heightfield of 3d samples like in the tesselation example
+    const int heightfieldsize = 1024;
+    std::vector<GLfloat> heightfieldData(3*heightfieldsize*heightfieldsize);
+    for(int y = 0;y<heightfieldsize;++y) {
+        for(int x = 0;x<heightfieldsize;++x) {
+            glm::vec2 pos(x, y);
+            heightfieldData[3*(y*heightfieldsize+x)+0] = 0.5f+0.5f*glm::perlin(0.01f*pos);
+            heightfieldData[3*(y*heightfieldsize+x)+1] = 0.5f+0.5f*glm::perlin(0.03f*pos);
+            heightfieldData[3*(y*heightfieldsize+x)+2] = 0.5f+0.5f*glm::perlin(0.09f*pos);
+        }
+    }
+
+    GLuint heightfield;
+    glGenTextures(1, &heightfield);
+    glBindTexture(GL_TEXTURE_2D, heightfield);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    bool full_precision = true;
+    tracker.tex_image_2d(heightfield, GL_RGB32F, heightfieldsize, heightfieldsize, GL_RGB, GL_FLOAT,
+                         &heightfieldData[0], true, TEXTURES, "heightfield");
+
+    // triple buffered particles, the cpu updates one buffer while
+    // the gpu may still be reading the others
+    const int particlebuffers = 3;
+    const int particles = 128*1024;
+    GLuint particle_vao[particlebuffers], particle_vbo[particlebuffers];
+    glGenVertexArrays(particlebuffers, particle_vao);
+    glGenBuffers(particlebuffers, particle_vbo);
+
+    std::vector<glm::vec3> particleData(particles);
+    for(int i = 0;i<particles;++i) {
+        particleData[i] = chunkrange*chunksize*glm::vec3(
+            2.0f*std::rand()/float(RAND_MAX)-1.0f,
+            2.0f*std::rand()/float(RAND_MAX)-1.0f,
+            2.0f*std::rand()/float(RAND_MAX)-1.0f);
+    }
+
+    for(int i = 0;i<particlebuffers;++i) {
+        glBindVertexArray(particle_vao[i]);
+        tracker.buffer_data(GL_ARRAY_BUFFER, particle_vbo[i], sizeof(glm::vec3)*particles,
+                            &particleData[0], GL_STREAM_DRAW, STREAMING, "particles");
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+    }
+
+    // window sized render targets, these get reallocated on resize
+    GLuint scene_color, scene_depth, fbo;
+    glGenTextures(1, &scene_color);
+    glBindTexture(GL_TEXTURE_2D, scene_color);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenTextures(1, &scene_depth);
+    glBindTexture(GL_TEXTURE_2D, scene_depth);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &fbo);
+
+    int target_width = 0, target_height = 0;
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+
+    // set clear color to sky blue
+    glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    bool space_down = false;
+    bool r_down = false;
+    int frame = 0;
+
+    float t = glfwGetTime();
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // toggle the heightfield precision, the tracker replaces the
+        // old allocation of the texture
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            full_precision = !full_precision;
+            tracker.tex_image_2d(heightfield, full_precision?GL_RGB32F:GL_RGB16F, heightfieldsize, heightfieldsize,
+                                 GL_RGB, GL_FLOAT, &heightfieldData[0], true, TEXTURES, "heightfield");
+            std::cout << "heightfield is " << (full_precision?"GL_RGB32F":"GL_RGB16F") << std::endl;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // (re)allocate the render targets if the window size changed
+        int fbwidth, fbheight;
+        glfwGetFramebufferSize(window, &fbwidth, &fbheight);
+        if((fbwidth != target_width || fbheight != target_height) && fbwidth>0 && fbheight>0) {
+            target_width = fbwidth;
+            target_height = fbheight;
+            tracker.tex_image_2d(scene_color, GL_RGBA8, target_width, target_height, GL_RGBA, GL_UNSIGNED_BYTE,
+                                 0, false, RENDER_TARGETS, "scene color");
+            tracker.tex_image_2d(scene_depth, GL_DEPTH_COMPONENT24, target_width, target_height, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT,
+                                 0, false, RENDER_TARGETS, "scene depth");
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scene_color, 0);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, scene_depth, 0);
+        }
+
+        // print the report on demand and once everything is loaded
+        if((glfwGetKey(window, 'R') && !r_down) || frame == 1) {
+            tracker.report();
+            report_driver_memory();
+        }
+        r_down = glfwGetKey(window, 'R');
+
+        // let the particles fall and update the current buffer
+        float extent = chunkrange*chunksize;
+        for(int i = 0;i<particles;++i) {
+            particleData[i].y -= 4.0f*dt;
+            if(particleData[i].y < -extent)
+                particleData[i].y += 2.0f*extent;
+        }
+        int current_buffer = frame%particlebuffers;
+        glBindBuffer(GL_ARRAY_BUFFER, particle_vbo[current_buffer]);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec3)*particles, &particleData[0]);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, float(target_width) / target_height, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // render the scene to the render targets
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, target_width, target_height);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // draw the chunks
+        glUseProgram(shader_program);
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1i(heightfield_location, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, heightfield);
+        for(size_t i = 0;i<chunks.size();++i) {
+            if(chunks[i].quadcount == 0 || outside_frustum(chunks[i], position, ViewProjection, chunksize))
+                continue;
+            glBindVertexArray(chunks[i].vao);
+            glDrawElements(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, 0);
+        }
+
+        // draw the particles
+        glUseProgram(particle_program);
+        glUniformMatrix4fv(ParticleViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glBindVertexArray(particle_vao[current_buffer]);
+        glDrawArrays(GL_POINTS, 0, particles);
+
+        // copy to the window
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, target_width, target_height, 0, 0, target_width, target_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        ++frame;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // final report with the peak usage of the session
+    tracker.report();
+
+    // delete the created objects
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        tracker.delete_buffer(chunks[i].vbo);
+        tracker.delete_buffer(chunks[i].ibo);
+    }
+
+    glDeleteVertexArrays(particlebuffers, particle_vao);
+    for(int i = 0;i<particlebuffers;++i)
+        tracker.delete_buffer(particle_vbo[i]);
+
+    tracker.delete_texture(heightfield);
+    tracker.delete_texture(scene_color);
+    tracker.delete_texture(scene_depth);
+    glDeleteFramebuffers(1, &fbo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(particle_program, particle_vertex_shader);
+    glDetachShader(particle_program, particle_fragment_shader);
+    glDeleteShader(particle_vertex_shader);
+    glDeleteShader(particle_fragment_shader);
+    glDeleteProgram(particle_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
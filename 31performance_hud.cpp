@@ -0,0 +1,784 @@
+/* OpenGL example code - performance hud
+ *
+ * draws frame time graph, per pass gpu timings and counters as an
+ * overlay instead of printing them to the console. The whole hud is a
+ * single instanced draw: every character, bar and background panel is
+ * one instance of a quad. The instance data is written to a
+ * persistently mapped buffer with one region per frame in flight that
+ * is protected by a fence (like the camera buffer in the late latching
+ * example). The text uses a tiny 3x5 pixel font that is baked into a
+ * texture atlas at startup. The cpu and gpu cost of the hud itself are
+ * displayed as well and turn red when they exceed 0.1 ms.
+ *
+ * toggle the hud with space
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+
+// the font, each row of a glyph is one octal digit from top to
+// bottom with the most significant bit being the leftmost pixel
+struct Glyph {
+    char c;
+    unsigned short rows;
+};
+
+const Glyph font[] = {
+    {'0', 075557}, {'1', 026227}, {'2', 071747}, {'3', 071717}, {'4', 055711},
+    {'5', 074717}, {'6', 074757}, {'7', 071111}, {'8', 075757}, {'9', 075717},
+    {'A', 025755}, {'B', 065656}, {'C', 034443}, {'D', 065556}, {'E', 074647},
+    {'F', 074644}, {'G', 034553}, {'H', 055755}, {'I', 072227}, {'J', 011152},
+    {'K', 055655}, {'L', 044447}, {'M', 057755}, {'N', 065555}, {'O', 025552},
+    {'P', 065644}, {'Q', 025563}, {'R', 065655}, {'S', 034216}, {'T', 072222},
+    {'U', 055557}, {'V', 055552}, {'W', 055775}, {'X', 055255}, {'Y', 055222},
+    {'Z', 071247}, {'.', 000002}, {':', 002020}, {'-', 000700}, {'%', 051245},
+    {'/', 011244}, {'(', 024442}, {')', 021112}, {'=', 007070}, {'+', 002720},
+};
+const int glyphcount = sizeof(font)/sizeof(font[0]);
+
+// the atlas has 16x8 cells of 4x6 pixels, one per ascii character.
+// the glyph occupies the top left 3x5 pixels of its cell
+const int atlaswidth = 16*4;
+const int atlasheight = 8*6;
+
+// cell that is completely filled, used to draw solid rectangles
+const int solid_glyph = 127;
+
+std::vector<GLubyte> bake_font_atlas() {
+    std::vector<GLubyte> pixels(atlaswidth*atlasheight, 0);
+    for(int c = 0;c<128;++c) {
+        unsigned short rows = 0;
+        if(c == solid_glyph) {
+            rows = 077777;
+        } else {
+            // lower case letters use the upper case glyphs
+            char upper = (c>='a' && c<='z') ? c-'a'+'A' : c;
+            for(int i = 0;i<glyphcount;++i)
+                if(font[i].c == upper)
+                    rows = font[i].rows;
+        }
+        int cx = 4*(c%16), cy = 6*(c/16);
+        for(int y = 0;y<5;++y)
+            for(int x = 0;x<3;++x)
+                if((rows >> (3*(4-y)+(2-x))) & 1)
+                    pixels[(cy+y)*atlaswidth+cx+x] = 255;
+    }
+    return pixels;
+}
+
+// one instance of the hud draw: a rectangle in pixels, the glyph to
+// fill it with and the color
+struct HudQuad {
+    GLshort x, y, w, h;
+    GLubyte glyph, padding[3];
+    GLubyte color[4];
+};
+
+// the hud geometry for the frames in flight. quads are written
+// directly into the persistently mapped buffer and drawn with a
+// single instanced draw call
+class HudRing {
+public:
+    HudRing(int quads_per_frame)
+    : capacity(quads_per_frame), current_slot(0), count(0)
+    {
+        for(int i = 0;i<slotcount;++i)
+            fences[i] = 0;
+
+        glGenVertexArrays(1, &vao);
+        glBindVertexArray(vao);
+
+        glGenBuffers(1, &vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, slotcount*capacity*sizeof(HudQuad), 0, flags);
+        quads = static_cast<HudQuad*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, slotcount*capacity*sizeof(HudQuad), flags));
+
+        // all attributes are per instance, the quad corners are
+        // generated from the VertexID
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 4, GL_SHORT, GL_FALSE, sizeof(HudQuad), (char*)0 + 0);
+        glVertexAttribDivisor(0, 1);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(1, 1, GL_UNSIGNED_BYTE, sizeof(HudQuad), (char*)0 + 4*sizeof(GLshort));
+        glVertexAttribDivisor(1, 1);
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudQuad), (char*)0 + 4*sizeof(GLshort) + 4);
+        glVertexAttribDivisor(2, 1);
+    }
+
+    ~HudRing()
+    {
+        for(int i = 0;i<slotcount;++i)
+            if(fences[i])
+                glDeleteSync(fences[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+    }
+
+    // wait until the gpu is done with the region we are about to reuse
+    void begin()
+    {
+        if(fences[current_slot]) {
+            glClientWaitSync(fences[current_slot], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+            glDeleteSync(fences[current_slot]);
+            fences[current_slot] = 0;
+        }
+        count = 0;
+    }
+
+    void rect(int x, int y, int w, int h, unsigned rgba, int glyph = solid_glyph)
+    {
+        if(count == capacity)
+            return;
+        HudQuad &quad = quads[current_slot*capacity + count++];
+        quad.x = x;
+        quad.y = y;
+        quad.w = w;
+        quad.h = h;
+        quad.glyph = glyph;
+        quad.color[0] = rgba>>24;
+        quad.color[1] = rgba>>16;
+        quad.color[2] = rgba>>8;
+        quad.color[3] = rgba;
+    }
+
+    // returns the x coordinate after the text
+    int text(int x, int y, const char *str, unsigned rgba)
+    {
+        for(;*str;++str, x += 4*scale)
+            if(*str != ' ')
+                rect(x, y, 3*scale, 5*scale, rgba, *str & 127);
+        return x;
+    }
+
+    // draw everything that was added since begin, the vao and base
+    // instance select the region of this frame
+    void draw()
+    {
+        glBindVertexArray(vao);
+        glDrawArraysInstancedBaseInstance(GL_TRIANGLE_STRIP, 0, 4, count, current_slot*capacity);
+        fences[current_slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current_slot = (current_slot + 1)%slotcount;
+    }
+
+    int quadcount() const { return count; }
+
+    // size of a font pixel in screen pixels
+    static const int scale = 2;
+
+private:
+    static const int slotcount = 3;
+    int capacity, current_slot, count;
+    GLuint vao, vbo;
+    HudQuad *quads;
+    GLsync fences[slotcount];
+};
+
+// colors that indicate whether a value is within budget
+unsigned budget_color(double value, double budget) {
+    if(value <= budget) return 0x80ff80ff;
+    if(value <= 2*budget) return 0xffff60ff;
+    return 0xff6060ff;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "31performance_hud", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n" // the projection matrix uniform
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   fcolor = vcolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // the post pass is a full screen triangle that applies a vignette
+    std::string post_vertex_source =
+        "#version 330\n"
+        "out vec2 txcoord;\n"
+        "void main() {\n"
+        "   txcoord = vec2(gl_VertexID%2, gl_VertexID/2)*2.0;\n"
+        "   gl_Position = vec4(2.0*txcoord-1.0, 0, 1);\n"
+        "}\n";
+
+    std::string post_fragment_source =
+        "#version 330\n"
+        "uniform sampler2D scene;\n"
+        "in vec2 txcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   vec2 d = txcoord-0.5;\n"
+        "   FragColor = texture(scene, txcoord)*(1.0-dot(d,d));\n"
+        "}\n";
+
+    // the hud vertex shader expands each instance to a quad and
+    // converts from pixels with the origin at the top left
+    std::string hud_vertex_source =
+        "#version 330\n"
+        "uniform vec2 screensize;\n"
+        "layout(location = 0) in vec4 rect;\n"
+        "layout(location = 1) in uint glyph;\n"
+        "layout(location = 2) in vec4 color;\n"
+        "out vec2 txcoord;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   vec2 corner = vec2(gl_VertexID%2, gl_VertexID/2);\n"
+        "   vec2 pos = rect.xy + corner*rect.zw;\n"
+        "   vec2 cell = vec2(glyph%16u, glyph/16u);\n"
+        "   txcoord = (cell*vec2(4,6) + corner*vec2(3,5))/vec2(64,48);\n"
+        "   fcolor = color;\n"
+        "   gl_Position = vec4(2.0*pos.x/screensize.x-1.0, 1.0-2.0*pos.y/screensize.y, 0, 1);\n"
+        "}\n";
+
+    std::string hud_fragment_source =
+        "#version 330\n"
+        "uniform sampler2D font;\n"
+        "in vec2 txcoord;\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(fcolor.rgb, fcolor.a*texture(font, txcoord).r);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+    GLuint post_program, post_vertex_shader, post_fragment_shader;
+    GLuint hud_program, hud_vertex_shader, hud_fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // create and compiler post vertex shader
+    post_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = post_vertex_source.c_str();
+    length = post_vertex_source.size();
+    glShaderSource(post_vertex_shader, 1, &source, &length);
+    glCompileShader(post_vertex_shader);
+    if(!check_shader_compile_status(post_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler post fragment shader
+    post_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = post_fragment_source.c_str();
+    length = post_fragment_source.size();
+    glShaderSource(post_fragment_shader, 1, &source, &length);
+    glCompileShader(post_fragment_shader);
+    if(!check_shader_compile_status(post_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    post_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(post_program, post_vertex_shader);
+    glAttachShader(post_program, post_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(post_program);
+    check_program_link_status(post_program);
+
+    // create and compiler hud vertex shader
+    hud_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = hud_vertex_source.c_str();
+    length = hud_vertex_source.size();
+    glShaderSource(hud_vertex_shader, 1, &source, &length);
+    glCompileShader(hud_vertex_shader);
+    if(!check_shader_compile_status(hud_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler hud fragment shader
+    hud_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = hud_fragment_source.c_str();
+    length = hud_fragment_source.size();
+    glShaderSource(hud_fragment_shader, 1, &source, &length);
+    glCompileShader(hud_fragment_shader);
+    if(!check_shader_compile_status(hud_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    hud_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(hud_program, hud_vertex_shader);
+    glAttachShader(hud_program, hud_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(hud_program);
+    check_program_link_status(hud_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint scene_location = glGetUniformLocation(post_program, "scene");
+    GLint screensize_location = glGetUniformLocation(hud_program, "screensize");
+    GLint font_location = glGetUniformLocation(hud_program, "font");
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    // the post pass has no vertex data
+    GLuint post_vao;
+    glGenVertexArrays(1, &post_vao);
+
+    // scene render target
+    GLuint scene_texture, scene_depth, fbo;
+    glGenTextures(1, &scene_texture);
+    glBindTexture(GL_TEXTURE_2D, scene_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+    glGenRenderbuffers(1, &scene_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, scene_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scene_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, scene_depth);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // bake the font into the atlas texture
+    std::vector<GLubyte> atlas = bake_font_atlas();
+    GLuint font_texture;
+    glGenTextures(1, &font_texture);
+    glBindTexture(GL_TEXTURE_2D, font_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlaswidth, atlasheight, 0, GL_RED, GL_UNSIGNED_BYTE, &atlas[0]);
+
+    HudRing *hud = new HudRing(1024);
+
+    // frame time history for the graph
+    const int historysize = 128;
+    float history[historysize];
+    std::fill(history, history+historysize, 0.0f);
+    int history_index = 0;
+
+    // timer query setup, one query for each pass
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint scene_queries[querycount], post_queries[querycount], hud_queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, scene_queries);
+    glGenQueries(querycount, post_queries);
+    glGenQueries(querycount, hud_queries);
+    GLuint64 scene_result = 0, post_result = 0, hud_result = 0;
+
+    // the hud cpu time of the previous frame
+    double hud_cpu = 0.0;
+
+    bool show_hud = true;
+    bool space_down = false;
+
+    float last_time = glfwGetTime();
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+        history[history_index] = 1000.0f*(t-last_time);
+        history_index = (history_index+1)%historysize;
+        last_time = t;
+
+        // toggle the hud
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            show_hud = !show_hud;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // render the scene to the fbo
+        glBeginQuery(GL_TIME_ELAPSED, scene_queries[current_query]);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glEnable(GL_DEPTH_TEST);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f*std::sin(0.1f*t), glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, -22.5f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set the uniform
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, 8*8*8);
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // apply the post pass to the window
+        glBeginQuery(GL_TIME_ELAPSED, post_queries[current_query]);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDisable(GL_DEPTH_TEST);
+        glUseProgram(post_program);
+        glUniform1i(scene_location, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene_texture);
+        glBindVertexArray(post_vao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // get timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(scene_queries[(current_query+1)%querycount])) {
+            glGetQueryObjectui64v(scene_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &scene_result);
+            glGetQueryObjectui64v(post_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &post_result);
+            glGetQueryObjectui64v(hud_queries[(current_query+1)%querycount], GL_QUERY_RESULT, &hud_result);
+        }
+
+        // draw the hud, everything from here to the draw counts
+        // towards its own cpu cost
+        glBeginQuery(GL_TIME_ELAPSED, hud_queries[current_query]);
+        if(show_hud) {
+            double hud_start = glfwGetTime();
+            hud->begin();
+
+            const int line = 7*HudRing::scale;
+            int x = 8, y = 8;
+            char buffer[64];
+
+            // background panel
+            hud->rect(x-4, y-4, 2*historysize+8, 6*line+70, 0x00000090);
+
+            float frametime = history[(history_index+historysize-1)%historysize];
+            std::sprintf(buffer, "FRAME %6.2f MS %5.0f FPS", frametime, 1000.0f/std::max(frametime, 0.001f));
+            hud->text(x, y, buffer, 0xffffffff);
+            y += line;
+
+            // frame time graph, the line marks 16.7 ms
+            const int graphheight = 60;
+            const float pixels_per_ms = 2.0f;
+            for(int i = 0;i<historysize;++i) {
+                float value = history[(history_index+i)%historysize];
+                int h = std::min(graphheight, int(pixels_per_ms*value));
+                hud->rect(x+2*i, y+graphheight-h, 2, h, budget_color(value, 1000.0/60.0));
+            }
+            hud->rect(x, y+graphheight-int(pixels_per_ms*1000.0f/60.0f), 2*historysize, 1, 0xffffff80);
+            y += graphheight + 4;
+
+            std::sprintf(buffer, "GPU SCENE %6.3f MS", scene_result*1.e-6);
+            hud->text(x, y, buffer, 0xffffffff);
+            y += line;
+            std::sprintf(buffer, "GPU POST  %6.3f MS", post_result*1.e-6);
+            hud->text(x, y, buffer, 0xffffffff);
+            y += line;
+
+            // the cost of the hud itself
+            x = hud->text(x, y, "HUD GPU", 0xffffffff);
+            std::sprintf(buffer, " %6.3f", hud_result*1.e-6);
+            x = hud->text(x, y, buffer, budget_color(hud_result*1.e-6, 0.1));
+            x = hud->text(x, y, " CPU", 0xffffffff);
+            std::sprintf(buffer, " %6.3f MS", hud_cpu);
+            hud->text(x, y, buffer, budget_color(hud_cpu, 0.1));
+            x = 8;
+            y += line;
+
+            std::sprintf(buffer, "QUADS %4d DRAWS 1", hud->quadcount());
+            hud->text(x, y, buffer, 0xffffffff);
+
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glUseProgram(hud_program);
+            glUniform2f(screensize_location, width, height);
+            glUniform1i(font_location, 0);
+            glBindTexture(GL_TEXTURE_2D, font_texture);
+            hud->draw();
+            glDisable(GL_BLEND);
+
+            hud_cpu = 1000.0*(glfwGetTime()-hud_start);
+        }
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    delete hud;
+
+    glDeleteQueries(querycount, scene_queries);
+    glDeleteQueries(querycount, post_queries);
+    glDeleteQueries(querycount, hud_queries);
+
+    glDeleteTextures(1, &font_texture);
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &scene_depth);
+    glDeleteTextures(1, &scene_texture);
+
+    glDeleteVertexArrays(1, &post_vao);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(post_program, post_vertex_shader);
+    glDetachShader(post_program, post_fragment_shader);
+    glDeleteShader(post_vertex_shader);
+    glDeleteShader(post_fragment_shader);
+    glDeleteProgram(post_program);
+
+    glDetachShader(hud_program, hud_vertex_shader);
+    glDetachShader(hud_program, hud_fragment_shader);
+    glDeleteShader(hud_vertex_shader);
+    glDeleteShader(hud_fragment_shader);
+    glDeleteProgram(hud_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
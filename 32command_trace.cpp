@@ -0,0 +1,1286 @@
+/* OpenGL example code - command trace capture and replay
+ *
+ * renders the occlusion culled voxel landscape of the queries and
+ * conditional render example with every GL call going through a thin
+ * capture layer. The layer executes the calls and records them into a
+ * binary trace. Payloads (buffer data, shader sources, uniform values)
+ * are stored once per unique content: they are hashed and identical
+ * blobs are referenced instead of stored again, so the identical
+ * bounding box index buffers and unchanged matrices of a static camera
+ * cost almost nothing. The trace consists of the setup calls followed
+ * by the calls of the captured frames.
+ *
+ * The replay mode loads a trace into an invisible window, executes the
+ * setup once and then loops over the captured frames. Every call is
+ * followed by a GL_TIMESTAMP query so the gpu time between consecutive
+ * calls can be attributed to them. The timestamps serialize the
+ * pipeline to some extent so the sum is higher than the frame time
+ * without them, but the ranking of the expensive calls is meaningful.
+ *
+ * capture: 32command_trace [tracefile] [frames]
+ *     press C to capture the next frames to the trace file
+ *     move with WASD keys and mouse use Q and E to "roll"
+ *     toggle occlusion culling with space
+ * replay: 32command_trace --replay [tracefile] [loops]
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    GLuint bounding_vbo, bounding_ibo, bounding_vao;
+    GLuint query;
+    int quadcount;
+    glm::vec3 center;
+};
+
+// predicate to allow sorting chunks by distance from a point
+class DistancePred {
+public:
+    DistancePred(glm::vec3 p) : pos(p) { }
+    bool operator()(const Chunk &a, const Chunk &b) {
+        return glm::distance(pos, a.center) < glm::distance(pos, b.center);
+    }
+private:
+    const glm::vec3 pos;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// the recorded calls, each command is the opcode followed by
+// a fixed number of 32bit arguments
+enum Opcode {
+    OP_GEN_BUFFER, OP_BIND_BUFFER, OP_BUFFER_DATA,
+    OP_GEN_VERTEX_ARRAY, OP_BIND_VERTEX_ARRAY,
+    OP_ENABLE_VERTEX_ATTRIB_ARRAY, OP_VERTEX_ATTRIB_POINTER,
+    OP_CREATE_SHADER, OP_SHADER_SOURCE, OP_COMPILE_SHADER,
+    OP_CREATE_PROGRAM, OP_ATTACH_SHADER, OP_LINK_PROGRAM,
+    OP_GET_UNIFORM_LOCATION, OP_USE_PROGRAM, OP_UNIFORM_MATRIX4FV,
+    OP_GEN_QUERY, OP_BEGIN_QUERY, OP_END_QUERY,
+    OP_BEGIN_CONDITIONAL_RENDER, OP_END_CONDITIONAL_RENDER,
+    OP_ENABLE, OP_DISABLE, OP_COLOR_MASK, OP_DEPTH_MASK,
+    OP_CLEAR_COLOR, OP_CLEAR, OP_DRAW_ELEMENTS,
+    OP_END_SETUP, OP_END_FRAME,
+    OP_COUNT
+};
+
+struct OpcodeInfo {
+    const char *name;
+    int argcount;
+};
+
+const OpcodeInfo opcodes[OP_COUNT] = {
+    {"glGenBuffers", 1}, {"glBindBuffer", 2}, {"glBufferData", 4},
+    {"glGenVertexArrays", 1}, {"glBindVertexArray", 1},
+    {"glEnableVertexAttribArray", 1}, {"glVertexAttribPointer", 6},
+    {"glCreateShader", 2}, {"glShaderSource", 2}, {"glCompileShader", 1},
+    {"glCreateProgram", 1}, {"glAttachShader", 2}, {"glLinkProgram", 1},
+    {"glGetUniformLocation", 3}, {"glUseProgram", 1}, {"glUniformMatrix4fv", 2},
+    {"glGenQueries", 1}, {"glBeginQuery", 2}, {"glEndQuery", 1},
+    {"glBeginConditionalRender", 2}, {"glEndConditionalRender", 0},
+    {"glEnable", 1}, {"glDisable", 1}, {"glColorMask", 4}, {"glDepthMask", 1},
+    {"glClearColor", 4}, {"glClear", 1}, {"glDrawElements", 4},
+    {"end setup", 0}, {"end frame", 0},
+};
+
+// blob index used for null data pointers
+const GLuint no_blob = 0xffffffff;
+
+GLuint float_bits(GLfloat value) {
+    GLuint bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+GLfloat bits_float(GLuint bits) {
+    GLfloat value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// 64bit FNV-1a hash to find duplicate payloads
+unsigned long long fnv1a(const char *data, size_t size) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for(size_t i = 0;i<size;++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// the capture layer, every call is executed and, while recording,
+// appended to the command stream. object names are recorded as the
+// driver returned them and remapped on replay
+class Tracer {
+public:
+    Tracer() : recording(true), capture_frames(0), submitted_bytes(0),
+               setup_commands(0), setup_blobs(0), setup_bytes(0) { }
+
+    GLuint gen_buffer() { GLuint name; glGenBuffers(1, &name); record(OP_GEN_BUFFER, name); return name; }
+    void bind_buffer(GLenum target, GLuint name) { glBindBuffer(target, name); record(OP_BIND_BUFFER, target, name); }
+    void buffer_data(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        glBufferData(target, size, data, usage);
+        record(OP_BUFFER_DATA, target, size, data?blob(data, size):no_blob, usage);
+    }
+    GLuint gen_vertex_array() { GLuint name; glGenVertexArrays(1, &name); record(OP_GEN_VERTEX_ARRAY, name); return name; }
+    void bind_vertex_array(GLuint name) { glBindVertexArray(name); record(OP_BIND_VERTEX_ARRAY, name); }
+    void enable_vertex_attrib_array(GLuint index) { glEnableVertexAttribArray(index); record(OP_ENABLE_VERTEX_ATTRIB_ARRAY, index); }
+    void vertex_attrib_pointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, size_t offset)
+    {
+        glVertexAttribPointer(index, size, type, normalized, stride, (char*)0 + offset);
+        record(OP_VERTEX_ATTRIB_POINTER, index, size, type, normalized, stride, offset);
+    }
+    GLuint create_shader(GLenum type) { GLuint name = glCreateShader(type); record(OP_CREATE_SHADER, type, name); return name; }
+    void shader_source(GLuint shader, const std::string &source)
+    {
+        const char *str = source.c_str();
+        int length = source.size();
+        glShaderSource(shader, 1, &str, &length);
+        record(OP_SHADER_SOURCE, shader, blob(str, length));
+    }
+    void compile_shader(GLuint shader) { glCompileShader(shader); record(OP_COMPILE_SHADER, shader); }
+    GLuint create_program() { GLuint name = glCreateProgram(); record(OP_CREATE_PROGRAM, name); return name; }
+    void attach_shader(GLuint program, GLuint shader) { glAttachShader(program, shader); record(OP_ATTACH_SHADER, program, shader); }
+    void link_program(GLuint program) { glLinkProgram(program); record(OP_LINK_PROGRAM, program); }
+    GLint get_uniform_location(GLuint program, const char *name)
+    {
+        GLint location = glGetUniformLocation(program, name);
+        record(OP_GET_UNIFORM_LOCATION, program, blob(name, std::strlen(name)+1), location);
+        return location;
+    }
+    void use_program(GLuint program) { glUseProgram(program); record(OP_USE_PROGRAM, program); }
+    void uniform_matrix4fv(GLint location, const GLfloat *value)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, value);
+        record(OP_UNIFORM_MATRIX4FV, location, blob(value, 16*sizeof(GLfloat)));
+    }
+    GLuint gen_query() { GLuint name; glGenQueries(1, &name); record(OP_GEN_QUERY, name); return name; }
+    void begin_query(GLenum target, GLuint query) { glBeginQuery(target, query); record(OP_BEGIN_QUERY, target, query); }
+    void end_query(GLenum target) { glEndQuery(target); record(OP_END_QUERY, target); }
+    void begin_conditional_render(GLuint query, GLenum mode) { glBeginConditionalRender(query, mode); record(OP_BEGIN_CONDITIONAL_RENDER, query, mode); }
+    void end_conditional_render() { glEndConditionalRender(); record(OP_END_CONDITIONAL_RENDER); }
+    void enable(GLenum cap) { glEnable(cap); record(OP_ENABLE, cap); }
+    void disable(GLenum cap) { glDisable(cap); record(OP_DISABLE, cap); }
+    void color_mask(GLboolean r, GLboolean g, GLboolean b, GLboolean a) { glColorMask(r, g, b, a); record(OP_COLOR_MASK, r, g, b, a); }
+    void depth_mask(GLboolean flag) { glDepthMask(flag); record(OP_DEPTH_MASK, flag); }
+    void clear_color(GLfloat r, GLfloat g, GLfloat b, GLfloat a)
+    {
+        glClearColor(r, g, b, a);
+        record(OP_CLEAR_COLOR, float_bits(r), float_bits(g), float_bits(b), float_bits(a));
+    }
+    void clear(GLbitfield mask) { glClear(mask); record(OP_CLEAR, mask); }
+    void draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset)
+    {
+        glDrawElements(mode, count, type, (char*)0 + offset);
+        record(OP_DRAW_ELEMENTS, mode, count, type, offset);
+    }
+
+    // everything up to here is recorded unconditionally, the frames
+    // only while a capture is running
+    void end_setup()
+    {
+        record(OP_END_SETUP);
+        recording = false;
+        setup_commands = commands.size();
+        setup_blobs = blobs.size();
+        setup_bytes = submitted_bytes;
+    }
+
+    // drop the frames of a previous capture so every trace contains
+    // the setup and only the frames of its own capture
+    void capture(int frames)
+    {
+        commands.resize(setup_commands);
+        blobs.resize(setup_blobs);
+        submitted_bytes = setup_bytes;
+        for(std::map<unsigned long long, GLuint>::iterator i = blob_index.begin();i!=blob_index.end();) {
+            if(i->second >= setup_blobs)
+                blob_index.erase(i++);
+            else
+                ++i;
+        }
+        capture_frames = frames;
+        recording = true;
+    }
+
+    bool capturing() const { return capture_frames > 0; }
+
+    // returns true when the last captured frame ended
+    bool end_frame()
+    {
+        if(!recording)
+            return false;
+        record(OP_END_FRAME);
+        if(--capture_frames > 0)
+            return false;
+        recording = false;
+        return true;
+    }
+
+    bool write(const char *filename, int width, int height) const
+    {
+        std::ofstream file(filename, std::ios::binary);
+        if(!file)
+            return false;
+        file.write("GLTRACE1", 8);
+        GLuint header[3] = { GLuint(width), GLuint(height), GLuint(blobs.size()) };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        size_t stored_bytes = 0;
+        for(size_t i = 0;i<blobs.size();++i) {
+            GLuint size = blobs[i].size();
+            file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            if(size)
+                file.write(&blobs[i][0], size);
+            stored_bytes += size;
+        }
+        GLuint commandsize = commands.size();
+        file.write(reinterpret_cast<const char*>(&commandsize), sizeof(commandsize));
+        if(!commands.empty())
+            file.write(reinterpret_cast<const char*>(&commands[0]), commands.size()*sizeof(GLuint));
+
+        std::cout << "wrote " << filename << ": " << commands.size()*sizeof(GLuint) << " bytes of commands, "
+                  << submitted_bytes << " bytes of payload stored as " << stored_bytes << " bytes in "
+                  << blobs.size() << " unique blobs" << std::endl;
+        return bool(file);
+    }
+
+private:
+    void record(Opcode op, GLuint a = 0, GLuint b = 0, GLuint c = 0, GLuint d = 0, GLuint e = 0, GLuint f = 0)
+    {
+        if(!recording)
+            return;
+        GLuint args[6] = {a, b, c, d, e, f};
+        commands.push_back(op);
+        commands.insert(commands.end(), args, args+opcodes[op].argcount);
+    }
+
+    // store a payload unless an identical one is already stored
+    GLuint blob(const void *data, size_t size)
+    {
+        if(!recording)
+            return no_blob;
+        const char *bytes = static_cast<const char*>(data);
+        submitted_bytes += size;
+        unsigned long long hash = fnv1a(bytes, size);
+        std::map<unsigned long long, GLuint>::iterator found = blob_index.find(hash);
+        if(found != blob_index.end()) {
+            const std::vector<char> &existing = blobs[found->second];
+            if(existing.size() == size && (size == 0 || std::memcmp(&existing[0], bytes, size) == 0))
+                return found->second;
+        }
+        GLuint index = blobs.size();
+        blobs.push_back(std::vector<char>(bytes, bytes+size));
+        if(found == blob_index.end())
+            blob_index[hash] = index;
+        return index;
+    }
+
+    bool recording;
+    int capture_frames;
+    size_t submitted_bytes;
+    size_t setup_commands, setup_blobs, setup_bytes;
+    std::vector<GLuint> commands;
+    std::vector<std::vector<char> > blobs;
+    std::map<unsigned long long, GLuint> blob_index;
+};
+
+// loads a trace and executes it with the recorded names mapped to
+// the objects created during the replay
+class Replayer {
+public:
+    Replayer() : width(0), height(0), current_program(0) { }
+
+    bool load(const char *filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if(!file)
+            return false;
+
+        // every count and size read from the file is checked against
+        // the bytes that are left before anything is allocated
+        file.seekg(0, std::ios::end);
+        std::streamoff end = file.tellg();
+        if(end < 0)
+            return false;
+        size_t remaining = end;
+        file.seekg(0, std::ios::beg);
+
+        char magic[8];
+        GLuint header[3];
+        if(remaining < sizeof(magic)+sizeof(header) || !file.read(magic, 8) ||
+           std::memcmp(magic, "GLTRACE1", 8) != 0 || !file.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+        remaining -= sizeof(magic)+sizeof(header);
+        width = header[0];
+        height = header[1];
+
+        // each blob has at least its size field
+        if(header[2] > remaining/sizeof(GLuint))
+            return false;
+        blobs.resize(header[2]);
+        for(size_t i = 0;i<blobs.size();++i) {
+            GLuint size = 0;
+            if(remaining < sizeof(size) || !file.read(reinterpret_cast<char*>(&size), sizeof(size)))
+                return false;
+            remaining -= sizeof(size);
+            if(size > remaining)
+                return false;
+            blobs[i].resize(size);
+            if(size && !file.read(&blobs[i][0], size))
+                return false;
+            remaining -= size;
+        }
+
+        GLuint commandsize = 0;
+        if(remaining < sizeof(commandsize) || !file.read(reinterpret_cast<char*>(&commandsize), sizeof(commandsize)))
+            return false;
+        remaining -= sizeof(commandsize);
+        if(commandsize > remaining/sizeof(GLuint))
+            return false;
+        commands.resize(commandsize);
+        if(commandsize && !file.read(reinterpret_cast<char*>(&commands[0]), commandsize*sizeof(GLuint)))
+            return false;
+
+        // split the stream into the setup and the frames
+        frames.push_back(std::vector<size_t>());
+        for(size_t i = 0;i<commands.size();i += 1+opcodes[commands[i]].argcount) {
+            if(commands[i] >= OP_COUNT || !valid_command(i))
+                return false;
+            if(commands[i] == OP_END_SETUP) {
+                setup.swap(frames.back());
+            } else if(commands[i] == OP_END_FRAME) {
+                frames.push_back(std::vector<size_t>());
+            } else {
+                frames.back().push_back(i);
+            }
+        }
+        frames.pop_back();
+        return true;
+    }
+
+    void run_setup()
+    {
+        for(size_t i = 0;i<setup.size();++i)
+            execute(setup[i]);
+    }
+
+    // executes a frame and issues a timestamp query before the frame
+    // and after every call
+    void run_frame(int frame, const std::vector<GLuint> &timestamps)
+    {
+        const std::vector<size_t> &calls = frames[frame];
+        glQueryCounter(timestamps[0], GL_TIMESTAMP);
+        for(size_t i = 0;i<calls.size();++i) {
+            execute(calls[i]);
+            glQueryCounter(timestamps[i+1], GL_TIMESTAMP);
+        }
+    }
+
+    // delete all the objects the replay created
+    void cleanup()
+    {
+        for(NameMap::iterator i = buffers.begin();i!=buffers.end();++i)
+            glDeleteBuffers(1, &i->second);
+        for(NameMap::iterator i = vertex_arrays.begin();i!=vertex_arrays.end();++i)
+            glDeleteVertexArrays(1, &i->second);
+        for(NameMap::iterator i = queries.begin();i!=queries.end();++i)
+            glDeleteQueries(1, &i->second);
+        for(NameMap::iterator i = programs.begin();i!=programs.end();++i)
+            glDeleteProgram(i->second);
+        for(NameMap::iterator i = shaders.begin();i!=shaders.end();++i)
+            glDeleteShader(i->second);
+    }
+
+    const GLuint* arguments(size_t command) const { return &commands[command+1]; }
+    Opcode opcode(size_t command) const { return Opcode(commands[command]); }
+
+    int width, height;
+    std::vector<size_t> setup;
+    std::vector<std::vector<size_t> > frames;
+
+private:
+    typedef std::map<GLuint, GLuint> NameMap;
+
+    GLuint remap(NameMap &names, GLuint name)
+    {
+        NameMap::iterator i = names.find(name);
+        return i == names.end() ? 0 : i->second;
+    }
+
+    // check that the arguments of a command are inside the stream and
+    // its blobs exist and are large enough for what execute reads
+    bool valid_command(size_t command) const
+    {
+        Opcode op = opcode(command);
+        if(commands.size()-command-1 < size_t(opcodes[op].argcount))
+            return false;
+        const GLuint *a = arguments(command);
+        switch(op) {
+            case OP_BUFFER_DATA:
+                return a[2] == no_blob || (a[2] < blobs.size() && a[1] <= blobs[a[2]].size());
+            case OP_SHADER_SOURCE:
+                return a[1] < blobs.size();
+            case OP_GET_UNIFORM_LOCATION:
+                return a[1] < blobs.size() && !blobs[a[1]].empty() && blobs[a[1]].back() == '\0';
+            case OP_UNIFORM_MATRIX4FV:
+                return a[1] < blobs.size() && blobs[a[1]].size() >= 16*sizeof(GLfloat);
+            default:
+                return true;
+        }
+    }
+
+    const void* payload(GLuint index)
+    {
+        return (index == no_blob || blobs[index].empty()) ? 0 : &blobs[index][0];
+    }
+
+    void execute(size_t command)
+    {
+        const GLuint *a = arguments(command);
+        switch(opcode(command)) {
+            case OP_GEN_BUFFER: glGenBuffers(1, &buffers[a[0]]); break;
+            case OP_BIND_BUFFER: glBindBuffer(a[0], remap(buffers, a[1])); break;
+            case OP_BUFFER_DATA: glBufferData(a[0], a[1], payload(a[2]), a[3]); break;
+            case OP_GEN_VERTEX_ARRAY: glGenVertexArrays(1, &vertex_arrays[a[0]]); break;
+            case OP_BIND_VERTEX_ARRAY: glBindVertexArray(remap(vertex_arrays, a[0])); break;
+            case OP_ENABLE_VERTEX_ATTRIB_ARRAY: glEnableVertexAttribArray(a[0]); break;
+            case OP_VERTEX_ATTRIB_POINTER: glVertexAttribPointer(a[0], a[1], a[2], a[3], a[4], (char*)0 + a[5]); break;
+            case OP_CREATE_SHADER: shaders[a[1]] = glCreateShader(a[0]); break;
+            case OP_SHADER_SOURCE: {
+                const char *source = static_cast<const char*>(payload(a[1]));
+                GLint length = blobs[a[1]].size();
+                glShaderSource(remap(shaders, a[0]), 1, &source, &length);
+                break;
+            }
+            case OP_COMPILE_SHADER: glCompileShader(remap(shaders, a[0])); break;
+            case OP_CREATE_PROGRAM: programs[a[0]] = glCreateProgram(); break;
+            case OP_ATTACH_SHADER: glAttachShader(remap(programs, a[0]), remap(shaders, a[1])); break;
+            case OP_LINK_PROGRAM: glLinkProgram(remap(programs, a[0])); break;
+            case OP_GET_UNIFORM_LOCATION:
+                uniforms[std::make_pair(a[0], GLint(a[2]))] =
+                    glGetUniformLocation(remap(programs, a[0]), static_cast<const char*>(payload(a[1])));
+                break;
+            case OP_USE_PROGRAM: current_program = a[0]; glUseProgram(remap(programs, a[0])); break;
+            case OP_UNIFORM_MATRIX4FV:
+                glUniformMatrix4fv(uniforms[std::make_pair(current_program, GLint(a[0]))], 1, GL_FALSE,
+                                   static_cast<const GLfloat*>(payload(a[1])));
+                break;
+            case OP_GEN_QUERY: glGenQueries(1, &queries[a[0]]); break;
+            case OP_BEGIN_QUERY: glBeginQuery(a[0], remap(queries, a[1])); break;
+            case OP_END_QUERY: glEndQuery(a[0]); break;
+            case OP_BEGIN_CONDITIONAL_RENDER: glBeginConditionalRender(remap(queries, a[0]), a[1]); break;
+            case OP_END_CONDITIONAL_RENDER: glEndConditionalRender(); break;
+            case OP_ENABLE: glEnable(a[0]); break;
+            case OP_DISABLE: glDisable(a[0]); break;
+            case OP_COLOR_MASK: glColorMask(a[0], a[1], a[2], a[3]); break;
+            case OP_DEPTH_MASK: glDepthMask(a[0]); break;
+            case OP_CLEAR_COLOR: glClearColor(bits_float(a[0]), bits_float(a[1]), bits_float(a[2]), bits_float(a[3])); break;
+            case OP_CLEAR: glClear(a[0]); break;
+            case OP_DRAW_ELEMENTS: glDrawElements(a[0], a[1], a[2], (char*)0 + a[3]); break;
+            default: break;
+        }
+    }
+
+    std::vector<GLuint> commands;
+    std::vector<std::vector<char> > blobs;
+    NameMap buffers, vertex_arrays, shaders, programs, queries;
+    std::map<std::pair<GLuint, GLint>, GLint> uniforms;
+    GLuint current_program;
+};
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// replays the trace headless and reports per call gpu timings
+int replay(const char *filename, int loops) {
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version, the window is never shown
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(64, 64, "32command_trace", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    Replayer replayer;
+    if(!replayer.load(filename) || replayer.frames.empty()) {
+        std::cerr << "failed to load " << filename << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+    std::cout << "replaying " << replayer.frames.size() << " frames at " << replayer.width << "x" << replayer.height
+              << ", " << replayer.setup.size() << " setup calls" << std::endl;
+
+    // the trace draws to the default framebuffer, replace it with an
+    // fbo of the captured size since the hidden window has no pixels
+    GLuint color_rbf, depth_rbf, fbo;
+    glGenRenderbuffers(1, &color_rbf);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_rbf);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, replayer.width, replayer.height);
+    glGenRenderbuffers(1, &depth_rbf);
+    glBindRenderbuffer(GL_RENDERBUFFER, depth_rbf);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, replayer.width, replayer.height);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rbf);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rbf);
+    glViewport(0, 0, replayer.width, replayer.height);
+
+    replayer.run_setup();
+
+    // timestamp queries for the largest frame
+    size_t maxcalls = 0;
+    for(size_t i = 0;i<replayer.frames.size();++i)
+        maxcalls = std::max(maxcalls, replayer.frames[i].size());
+    std::vector<GLuint> timestamps(maxcalls+1);
+    glGenQueries(timestamps.size(), &timestamps[0]);
+
+    // accumulated gpu time per call of every frame and per opcode
+    std::vector<std::vector<double> > call_time(replayer.frames.size());
+    for(size_t i = 0;i<replayer.frames.size();++i)
+        call_time[i].resize(replayer.frames[i].size(), 0.0);
+    std::vector<double> opcode_time(OP_COUNT, 0.0);
+    std::vector<int> opcode_calls(OP_COUNT, 0);
+
+    for(int loop = 0;loop<loops;++loop) {
+        double frames_gpu = 0.0;
+        double start = glfwGetTime();
+        for(size_t frame = 0;frame<replayer.frames.size();++frame) {
+            const std::vector<size_t> &calls = replayer.frames[frame];
+            replayer.run_frame(frame, timestamps);
+
+            // waiting for the results here is fine, nothing is
+            // displayed and the frames are replayed back to back
+            std::vector<GLuint64> times(calls.size()+1);
+            for(size_t i = 0;i<times.size();++i)
+                glGetQueryObjectui64v(timestamps[i], GL_QUERY_RESULT, &times[i]);
+
+            for(size_t i = 0;i<calls.size();++i) {
+                double ms = (times[i+1]-times[i])*1.e-6;
+                call_time[frame][i] += ms;
+                opcode_time[replayer.opcode(calls[i])] += ms;
+                opcode_calls[replayer.opcode(calls[i])] += 1;
+            }
+            frames_gpu += (times[calls.size()]-times[0])*1.e-6;
+        }
+        double cpu = 1000.0*(glfwGetTime()-start);
+        std::cout << "loop " << loop << ": " << frames_gpu/replayer.frames.size() << " ms gpu/frame, "
+                  << cpu/replayer.frames.size() << " ms cpu/frame" << std::endl;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+    }
+
+    // gpu time per call type
+    double total_frames = double(loops)*replayer.frames.size();
+    std::cout << std::endl << std::left << std::setw(28) << "call" << std::right
+              << std::setw(12) << "calls/frame" << std::setw(12) << "ms/frame" << std::endl;
+    for(int op = 0;op<OP_COUNT;++op) {
+        if(opcode_calls[op] == 0)
+            continue;
+        std::cout << std::left << std::setw(28) << opcodes[op].name << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(12) << opcode_calls[op]/total_frames << std::setw(12) << opcode_time[op]/total_frames << std::endl;
+    }
+
+    // the most expensive individual calls
+    std::vector<std::pair<double, std::pair<size_t, size_t> > > ranking;
+    for(size_t frame = 0;frame<call_time.size();++frame)
+        for(size_t i = 0;i<call_time[frame].size();++i)
+            ranking.push_back(std::make_pair(call_time[frame][i]/loops, std::make_pair(frame, i)));
+    size_t top = std::min<size_t>(10, ranking.size());
+    std::partial_sort(ranking.begin(), ranking.begin()+top, ranking.end(),
+                      std::greater<std::pair<double, std::pair<size_t, size_t> > >());
+    std::cout << std::endl << "most expensive calls (frame, call, ms, arguments)" << std::endl;
+    for(size_t i = 0;i<top;++i) {
+        size_t frame = ranking[i].second.first;
+        size_t command = replayer.frames[frame][ranking[i].second.second];
+        Opcode op = replayer.opcode(command);
+        std::cout << std::setw(4) << frame << std::setw(7) << ranking[i].second.second << std::setw(10) << ranking[i].first
+                  << "  " << opcodes[op].name << "(";
+        for(int j = 0;j<opcodes[op].argcount;++j)
+            std::cout << (j?", ":"") << replayer.arguments(command)[j];
+        std::cout << ")" << std::endl;
+    }
+
+    // delete the created objects
+
+    glDeleteQueries(timestamps.size(), &timestamps[0]);
+    replayer.cleanup();
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &color_rbf);
+    glDeleteRenderbuffers(1, &depth_rbf);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int width = 640;
+    int height = 480;
+
+    if(argc > 1 && std::strcmp(argv[1], "--replay") == 0)
+        return replay(argc > 2 ? argv[2] : "trace.bin", argc > 3 ? std::max(1, std::atoi(argv[3])) : 10);
+
+    const char *tracefile = argc > 1 ? argv[1] : "trace.bin";
+    int captureframes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "32command_trace", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // all GL calls of the scene go through the tracer
+    Tracer tracer;
+
+    // draw shader
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = abs(fcolor);\n"
+        "}\n";
+
+    // trivial shader for occlusion queries
+    std::string query_vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "void main() {\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string query_fragment_source =
+        "#version 330\n"
+        "void main() {\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+    GLuint query_shader_program, query_vertex_shader, query_fragment_shader;
+
+    // create and compiler vertex shader
+    vertex_shader = tracer.create_shader(GL_VERTEX_SHADER);
+    tracer.shader_source(vertex_shader, vertex_source);
+    tracer.compile_shader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = tracer.create_shader(GL_FRAGMENT_SHADER);
+    tracer.shader_source(fragment_shader, fragment_source);
+    tracer.compile_shader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = tracer.create_program();
+
+    // attach shaders
+    tracer.attach_shader(shader_program, vertex_shader);
+    tracer.attach_shader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    tracer.link_program(shader_program);
+    check_program_link_status(shader_program);
+
+    // create and compiler query vertex shader
+    query_vertex_shader = tracer.create_shader(GL_VERTEX_SHADER);
+    tracer.shader_source(query_vertex_shader, query_vertex_source);
+    tracer.compile_shader(query_vertex_shader);
+    if(!check_shader_compile_status(query_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler query fragment shader
+    query_fragment_shader = tracer.create_shader(GL_FRAGMENT_SHADER);
+    tracer.shader_source(query_fragment_shader, query_fragment_source);
+    tracer.compile_shader(query_fragment_shader);
+    if(!check_shader_compile_status(query_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    query_shader_program = tracer.create_program();
+
+    // attach shaders
+    tracer.attach_shader(query_shader_program, query_vertex_shader);
+    tracer.attach_shader(query_shader_program, query_fragment_shader);
+
+    // link the program and check for errors
+    tracer.link_program(query_shader_program);
+    check_program_link_status(query_shader_program);
+
+    // obtain location of projection uniform
+    GLint DrawViewProjection_location = tracer.get_uniform_location(shader_program, "ViewProjection");
+    GLint QueryViewProjection_location = tracer.get_uniform_location(query_shader_program, "ViewProjection");
+
+    // chunk container and chunk parameters
+    std::vector<Chunk> chunks;
+    int chunkrange = 3;
+    int chunksize = 32;
+
+    // chunk extraction
+    std::cout << "generating chunks, this may take a while." << std::endl;
+
+    // iterate over all chunks we want to extract
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+
+        // chunk data
+
+        // generate and bind the vao
+        chunk.vao = tracer.gen_vertex_array();
+        tracer.bind_vertex_array(chunk.vao);
+
+        // generate and bind the vertex buffer object
+        chunk.vbo = tracer.gen_buffer();
+        tracer.bind_buffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        generate_chunk(offset, chunksize, vertexData);
+
+        // upload
+        tracer.buffer_data(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), vertexData.empty()?0:&vertexData[0], GL_STATIC_DRAW);
+
+        // set up generic attrib pointers
+        tracer.enable_vertex_attrib_array(0);
+        tracer.vertex_attrib_pointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), 0*sizeof(GLfloat));
+
+        tracer.enable_vertex_attrib_array(1);
+        tracer.vertex_attrib_pointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), 3*sizeof(GLfloat));
+
+        // generate and bind the index buffer object
+        chunk.ibo = tracer.gen_buffer();
+        tracer.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo);
+
+        chunk.quadcount = vertexData.size()/8;
+        std::vector<GLuint> indexData(6*chunk.quadcount);
+        for(int i = 0;i<chunk.quadcount;++i) {
+            indexData[6*i + 0] = 4*i + 0;
+            indexData[6*i + 1] = 4*i + 1;
+            indexData[6*i + 2] = 4*i + 2;
+            indexData[6*i + 3] = 4*i + 2;
+            indexData[6*i + 4] = 4*i + 1;
+            indexData[6*i + 5] = 4*i + 3;
+        }
+
+        // upload
+        tracer.buffer_data(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), indexData.empty()?0:&indexData[0], GL_STATIC_DRAW);
+
+        // chunk bounding box
+        // generate and bind the vao
+        chunk.bounding_vao = tracer.gen_vertex_array();
+        tracer.bind_vertex_array(chunk.bounding_vao);
+
+        // generate and bind the vertex buffer object
+        chunk.bounding_vbo = tracer.gen_buffer();
+        tracer.bind_buffer(GL_ARRAY_BUFFER, chunk.bounding_vbo);
+
+        // data for the bounding cube
+        GLfloat boundingVertexData[] = {
+        //  X                           Y                           Z
+        // face 0:
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z+chunksize-0.5f,
+
+        // face 1:
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z+chunksize-0.5f,
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z-0.5f,
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z-0.5f,
+
+        // face 2:
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z-0.5f,
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z-0.5f,
+
+        // face 3:
+            offset.x+chunksize-0.5f,    offset.y+chunksize-0.5f,    offset.z-0.5f,
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z-0.5f,
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z-0.5f,
+
+        // face 4:
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y+chunksize-0.5f,    offset.z-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z-0.5f,
+
+        // face 5:
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z+chunksize-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z+chunksize-0.5f,
+            offset.x+chunksize-0.5f,    offset.y-0.5f,              offset.z-0.5f,
+            offset.x-0.5f,              offset.y-0.5f,              offset.z-0.5f,
+        }; // 6 faces with 4 vertices with 6 components (floats)
+
+        // fill with data
+        tracer.buffer_data(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*3, boundingVertexData, GL_STATIC_DRAW);
+
+        // set up generic attrib pointers
+        tracer.enable_vertex_attrib_array(0);
+        tracer.vertex_attrib_pointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), 0*sizeof(GLfloat));
+
+        // generate and bind the index buffer object
+        chunk.bounding_ibo = tracer.gen_buffer();
+        tracer.bind_buffer(GL_ELEMENT_ARRAY_BUFFER, chunk.bounding_ibo);
+
+        GLuint boundingIndexData[] = {
+             0, 1, 2, 2, 1, 3, 4, 5, 6, 6, 5, 7, 8, 9,10,10, 9,11,
+            12,13,14,14,13,15,16,17,18,18,17,19,20,21,22,22,21,23,
+        };
+
+        // fill with data, this is the same for every chunk and only
+        // stored once in the trace
+        tracer.buffer_data(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, boundingIndexData, GL_STATIC_DRAW);
+
+        // generate the query object for the occlusion query
+        chunk.query = tracer.gen_query();
+
+        // set the center location of the chunk
+        chunk.center = offset + 0.5f*chunksize;
+
+        // add to container
+        chunks.push_back(chunk);
+    }
+
+    // we are drawing 3d objects so we want depth testing
+    tracer.enable(GL_DEPTH_TEST);
+
+    // from here on only captured frames are recorded
+    tracer.end_setup();
+
+    // timer query setup, these are not traced
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    float t = glfwGetTime();
+    bool occlusion_cull = true;
+    bool space_down = false;
+    bool c_down = false;
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // toggle occlusion culling
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            occlusion_cull = !occlusion_cull;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // start a capture
+        if(glfwGetKey(window, 'C') && !c_down && !tracer.capturing()) {
+            std::cout << "capturing " << captureframes << " frames" << std::endl;
+            tracer.capture(captureframes);
+        }
+        c_down = glfwGetKey(window, 'C');
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set matrices for both shaders
+        tracer.use_program(query_shader_program);
+        tracer.uniform_matrix4fv(QueryViewProjection_location, glm::value_ptr(ViewProjection));
+        tracer.use_program(shader_program);
+        tracer.uniform_matrix4fv(DrawViewProjection_location, glm::value_ptr(ViewProjection));
+
+        // set clear color to sky blue
+        tracer.clear_color(0.5f,0.8f,1.0f,1.0f);
+
+        // clear
+        tracer.clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // sort chunks by distance
+        std::sort(chunks.begin(), chunks.end(), DistancePred(position));
+
+        size_t i = 0;
+        float maxdist = chunksize;
+
+        // start timer query
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        // peel chunks
+        while(i!=chunks.size()) {
+            size_t j = i;
+            if(occlusion_cull) {
+                // start occlusion queries and render for the current slice
+                tracer.disable(GL_CULL_FACE);
+
+                // we don't want the queries to actually render something
+                tracer.depth_mask(GL_FALSE);
+                tracer.color_mask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                tracer.use_program(query_shader_program);
+                for(;j<chunks.size() && glm::distance(chunks[j].center, position)<maxdist;++j) {
+                    // frustum culling
+                    glm::vec4 projected = ViewProjection*glm::vec4(chunks[j].center,1);
+                    if( (glm::distance(chunks[j].center,position) > chunksize) &&
+                        (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize))
+                        continue;
+
+                    // begin occlusion query
+                    tracer.begin_query(GL_ANY_SAMPLES_PASSED, chunks[j].query);
+
+                    // draw bounding box
+                    tracer.bind_vertex_array(chunks[j].bounding_vao);
+                    tracer.draw_elements(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0);
+
+                    // end occlusion query
+                    tracer.end_query(GL_ANY_SAMPLES_PASSED);
+                }
+                j = i;
+            }
+
+            // render the current slice
+            tracer.enable(GL_CULL_FACE);
+
+            // turn rendering back on
+            tracer.depth_mask(GL_TRUE);
+            tracer.color_mask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            tracer.use_program(shader_program);
+            for(;j<chunks.size() && glm::distance(chunks[j].center, position)<maxdist;++j) {
+                // frustum culling
+                glm::vec4 projected = ViewProjection*glm::vec4(chunks[j].center,1);
+                if( (glm::distance(chunks[j].center,position) > chunksize) &&
+                    (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize))
+                    continue;
+
+                // begin conditional render
+                if(occlusion_cull)
+                    tracer.begin_conditional_render(chunks[j].query, GL_QUERY_BY_REGION_WAIT);
+
+                // draw chunk
+                tracer.bind_vertex_array(chunks[j].vao);
+                tracer.draw_elements(GL_TRIANGLES, 6*chunks[j].quadcount, GL_UNSIGNED_INT, 0);
+
+                // end conditional render
+                if(occlusion_cull)
+                    tracer.end_conditional_render();
+            }
+            i = j;
+            maxdist += 2*chunksize;
+        }
+
+        // end timer query
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // write the trace after the last captured frame
+        if(tracer.end_frame()) {
+            if(!tracer.write(tracefile, width, height))
+                std::cerr << "failed to write " << tracefile << std::endl;
+        }
+
+        // display timer query results from querycount frames before
+        if(GL_TRUE == glIsQuery(queries[(current_query+1)%querycount])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[(current_query+1)%querycount], GL_QUERY_RESULT, &result);
+            std::cout << result*1.e-6 << " ms/frame" << std::endl;
+        }
+        // advance query counter
+        current_query = (current_query + 1)%querycount;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+    // delete the created objects
+
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+        glDeleteBuffers(1, &chunks[i].ibo);
+        glDeleteVertexArrays(1, &chunks[i].bounding_vao);
+        glDeleteBuffers(1, &chunks[i].bounding_vbo);
+        glDeleteBuffers(1, &chunks[i].bounding_ibo);
+        glDeleteQueries(1, &chunks[i].query);
+    }
+
+    glDeleteQueries(querycount, queries);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(query_shader_program, query_vertex_shader);
+    glDetachShader(query_shader_program, query_fragment_shader);
+    glDeleteShader(query_vertex_shader);
+    glDeleteShader(query_fragment_shader);
+    glDeleteProgram(query_shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,736 @@
+/* OpenGL example code - debug output
+ *
+ * instead of a single glGetError per frame this example creates a
+ * debug context and installs a glDebugMessageCallback. All objects get
+ * names with glObjectLabel and every pass is wrapped in a debug group,
+ * so the driver messages and tools like apitrace or renderdoc can refer
+ * to "instance colors (static)" in the "upload" pass instead of buffer
+ * 3. The callback tracks the group stack from the push/pop messages and
+ * collects the messages de-duplicated by source, type and id. Errors
+ * and the first occurrence of every warning are printed right away,
+ * everything else is summarized in a report at exit. Performance
+ * warnings are classified by what they usually indicate (buffer
+ * migrations, shader recompiles, sync stalls).
+ *
+ * Space toggles between two ways of doing the same work. The bad one
+ * updates a GL_STATIC_DRAW buffer that is in use and reads back the
+ * frame with a synchronous glReadPixels, which makes many drivers emit
+ * performance warnings. The good one orphans a GL_STREAM_DRAW buffer
+ * and reads back through pixel buffer objects guarded by fences.
+ *
+ * Defining NDEBUG builds the release variant: no debug context, no
+ * callback and no per frame glGetError. Labels and groups stay since
+ * they are cheap and useful in frame debuggers.
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+
+const char* debug_source_name(GLenum source) {
+    switch(source) {
+        case GL_DEBUG_SOURCE_API: return "api";
+        case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+        case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+        case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+        case GL_DEBUG_SOURCE_APPLICATION: return "application";
+        default: return "other";
+    }
+}
+
+const char* debug_type_name(GLenum type) {
+    switch(type) {
+        case GL_DEBUG_TYPE_ERROR: return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+        case GL_DEBUG_TYPE_MARKER: return "marker";
+        default: return "other";
+    }
+}
+
+const char* debug_severity_name(GLenum severity) {
+    switch(severity) {
+        case GL_DEBUG_SEVERITY_HIGH: return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM: return "medium";
+        case GL_DEBUG_SEVERITY_LOW: return "low";
+        default: return "notification";
+    }
+}
+
+// guess what a performance warning is about from its text, the
+// wording differs between vendors
+const char* performance_category(const std::string &message) {
+    std::string text = message;
+    std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+    if(text.find("recompil") != std::string::npos)
+        return "shader recompile";
+    if(text.find("stall") != std::string::npos || text.find("sync") != std::string::npos ||
+       text.find("wait") != std::string::npos || text.find("pixel-path") != std::string::npos)
+        return "sync stall";
+    if(text.find("migrat") != std::string::npos || text.find("moved") != std::string::npos ||
+       text.find("copied") != std::string::npos || text.find("memory") != std::string::npos)
+        return "buffer migration";
+    return "other";
+}
+
+// a de-duplicated debug message
+struct DebugEntry {
+    GLenum source, type, severity;
+    GLuint id;
+    std::string message, group;
+    int count, first_frame;
+};
+
+// predicate to sort the entries by how often they occurred
+class CountPred {
+public:
+    bool operator()(const DebugEntry &a, const DebugEntry &b) {
+        return a.count > b.count;
+    }
+};
+
+// collects the messages passed to the debug callback
+class DebugReport {
+public:
+    DebugReport() : frame(0) { }
+
+    void add(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string &message)
+    {
+        // keep track of the debug groups
+        if(type == GL_DEBUG_TYPE_PUSH_GROUP) {
+            groups.push_back(message);
+            return;
+        }
+        if(type == GL_DEBUG_TYPE_POP_GROUP) {
+            if(!groups.empty())
+                groups.pop_back();
+            return;
+        }
+
+        Key key(source, std::make_pair(type, id));
+        std::map<Key, DebugEntry>::iterator i = entries.find(key);
+        if(i != entries.end()) {
+            i->second.count += 1;
+            return;
+        }
+
+        DebugEntry entry;
+        entry.source = source;
+        entry.type = type;
+        entry.severity = severity;
+        entry.id = id;
+        entry.message = message;
+        entry.group = group_path();
+        entry.count = 1;
+        entry.first_frame = frame;
+        entries[key] = entry;
+
+        // print the first occurrence of everything but notifications
+        if(severity != GL_DEBUG_SEVERITY_NOTIFICATION) {
+            std::cerr << "[" << debug_type_name(type) << ", " << debug_severity_name(severity) << "] "
+                      << entry.group << ": " << message << std::endl;
+        }
+    }
+
+    void report() const
+    {
+        std::vector<DebugEntry> sorted;
+        for(std::map<Key, DebugEntry>::const_iterator i = entries.begin();i!=entries.end();++i)
+            sorted.push_back(i->second);
+        std::sort(sorted.begin(), sorted.end(), CountPred());
+
+        std::map<std::string, int> performance;
+        std::cout << "debug messages (" << sorted.size() << " unique)" << std::endl;
+        for(size_t i = 0;i<sorted.size();++i) {
+            const DebugEntry &entry = sorted[i];
+            std::cout << "  " << entry.count << "x " << debug_source_name(entry.source) << " "
+                      << debug_type_name(entry.type) << " " << debug_severity_name(entry.severity)
+                      << " id " << entry.id << " first in frame " << entry.first_frame << " in " << entry.group;
+            if(entry.type == GL_DEBUG_TYPE_PERFORMANCE) {
+                std::cout << " (" << performance_category(entry.message) << ")";
+                performance[performance_category(entry.message)] += entry.count;
+            }
+            std::cout << std::endl << "      " << entry.message << std::endl;
+        }
+        std::cout << "performance warnings by category" << std::endl;
+        for(std::map<std::string, int>::const_iterator i = performance.begin();i!=performance.end();++i)
+            std::cout << "  " << i->first << ": " << i->second << std::endl;
+    }
+
+    int frame;
+
+private:
+    typedef std::pair<GLenum, std::pair<GLenum, GLuint> > Key;
+
+    std::string group_path() const
+    {
+        if(groups.empty())
+            return "(no group)";
+        std::string path = groups[0];
+        for(size_t i = 1;i<groups.size();++i)
+            path += "/" + groups[i];
+        return path;
+    }
+
+    std::vector<std::string> groups;
+    std::map<Key, DebugEntry> entries;
+};
+
+void APIENTRY debug_callback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                             GLsizei length, const GLchar *message, const void *user) {
+    DebugReport *report = static_cast<DebugReport*>(const_cast<void*>(user));
+    report->add(source, type, id, severity, std::string(message, length >= 0 ? length : std::strlen(message)));
+}
+
+// pushes a debug group for the lifetime of the object
+class DebugGroup {
+public:
+    DebugGroup(const char *name) { glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name); }
+    ~DebugGroup() { glPopDebugGroup(); }
+};
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+#ifndef NDEBUG
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE);
+#endif
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "33debug_output", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+#ifndef NDEBUG
+    // install the callback, synchronous output makes the messages
+    // arrive in the call that caused them so the group is correct
+    DebugReport debug_report;
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(debug_callback, &debug_report);
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, 0, GL_TRUE);
+    glDebugMessageInsert(GL_DEBUG_SOURCE_APPLICATION, GL_DEBUG_TYPE_MARKER, 0,
+                         GL_DEBUG_SEVERITY_NOTIFICATION, -1, "debug output enabled");
+#endif
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n" // the projection matrix uniform
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "layout(location = 2) in vec4 icolor;\n" // per instance color
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   fcolor = vcolor*icolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // the post pass is a full screen triangle that applies a vignette
+    std::string post_vertex_source =
+        "#version 330\n"
+        "out vec2 txcoord;\n"
+        "void main() {\n"
+        "   txcoord = vec2(gl_VertexID%2, gl_VertexID/2)*2.0;\n"
+        "   gl_Position = vec4(2.0*txcoord-1.0, 0, 1);\n"
+        "}\n";
+
+    std::string post_fragment_source =
+        "#version 330\n"
+        "uniform sampler2D scene;\n"
+        "in vec2 txcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   vec2 d = txcoord-0.5;\n"
+        "   FragColor = texture(scene, txcoord)*(1.0-dot(d,d));\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+    GLuint post_program, post_vertex_shader, post_fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // create and compiler post vertex shader
+    post_vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = post_vertex_source.c_str();
+    length = post_vertex_source.size();
+    glShaderSource(post_vertex_shader, 1, &source, &length);
+    glCompileShader(post_vertex_shader);
+    if(!check_shader_compile_status(post_vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler post fragment shader
+    post_fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = post_fragment_source.c_str();
+    length = post_fragment_source.size();
+    glShaderSource(post_fragment_shader, 1, &source, &length);
+    glCompileShader(post_fragment_shader);
+    if(!check_shader_compile_status(post_fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    post_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(post_program, post_vertex_shader);
+    glAttachShader(post_program, post_fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(post_program);
+    check_program_link_status(post_program);
+
+    // name the shaders and programs
+    glObjectLabel(GL_SHADER, vertex_shader, -1, "cube vertex shader");
+    glObjectLabel(GL_SHADER, fragment_shader, -1, "cube fragment shader");
+    glObjectLabel(GL_PROGRAM, shader_program, -1, "cube program");
+    glObjectLabel(GL_SHADER, post_vertex_shader, -1, "post vertex shader");
+    glObjectLabel(GL_SHADER, post_fragment_shader, -1, "post fragment shader");
+    glObjectLabel(GL_PROGRAM, post_program, -1, "post program");
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint scene_location = glGetUniformLocation(post_program, "scene");
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    glObjectLabel(GL_VERTEX_ARRAY, vao, -1, "cube vao");
+    glObjectLabel(GL_BUFFER, vbo, -1, "cube vertices");
+    glObjectLabel(GL_BUFFER, ibo, -1, "cube indices");
+
+    // per instance colors, updated every frame. one buffer is used
+    // the wrong way and one the right way
+    const int instances = 8*8*8;
+    std::vector<glm::vec4> instanceData(instances);
+
+    GLuint static_instance_vbo, stream_instance_vbo;
+    glGenBuffers(1, &static_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, static_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4)*instances, &instanceData[0], GL_STATIC_DRAW);
+    glObjectLabel(GL_BUFFER, static_instance_vbo, -1, "instance colors (static)");
+
+    glGenBuffers(1, &stream_instance_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, stream_instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4)*instances, &instanceData[0], GL_STREAM_DRAW);
+    glObjectLabel(GL_BUFFER, stream_instance_vbo, -1, "instance colors (stream)");
+
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    // the post pass has no vertex data
+    GLuint post_vao;
+    glGenVertexArrays(1, &post_vao);
+    glObjectLabel(GL_VERTEX_ARRAY, post_vao, -1, "post vao");
+
+    // scene render target
+    GLuint scene_texture, scene_depth, fbo;
+    glGenTextures(1, &scene_texture);
+    glBindTexture(GL_TEXTURE_2D, scene_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    glObjectLabel(GL_TEXTURE, scene_texture, -1, "scene color");
+
+    glGenRenderbuffers(1, &scene_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, scene_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    glObjectLabel(GL_RENDERBUFFER, scene_depth, -1, "scene depth");
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, scene_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, scene_depth);
+    glObjectLabel(GL_FRAMEBUFFER, fbo, -1, "scene fbo");
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // readback of the frame, as a stand in for screenshots or picking.
+    // the pbos are only mapped once their fence has signaled
+    const int pbocount = 3;
+    GLuint pbos[pbocount];
+    GLsync fences[pbocount] = {0, 0, 0};
+    glGenBuffers(pbocount, pbos);
+    for(int i = 0;i<pbocount;++i) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4*width*height, 0, GL_STREAM_READ);
+        glObjectLabel(GL_BUFFER, pbos[i], -1, "readback pbo");
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    std::vector<GLubyte> readback(4*width*height);
+
+    bool bad_usage = true;
+    bool space_down = false;
+    int frame = 0;
+
+    std::cout << "using buffers the bad way" << std::endl;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle the usage patterns
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            bad_usage = !bad_usage;
+            std::cout << "using buffers the " << (bad_usage?"bad":"good") << " way" << std::endl;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+#ifndef NDEBUG
+        debug_report.frame = frame;
+#endif
+
+        DebugGroup frame_group("frame");
+
+        // animate the instance colors
+        for(int i = 0;i<instances;++i)
+            instanceData[i] = glm::vec4(0.6f+0.4f*std::sin(2.0f*t+0.1f*i));
+
+        GLuint instance_vbo = bad_usage ? static_instance_vbo : stream_instance_vbo;
+        {
+            DebugGroup group("upload");
+            glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+            if(!bad_usage) {
+                // orphan the old storage so we don't have to wait
+                // for the previous frame to finish reading it
+                glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec4)*instances, 0, GL_STREAM_DRAW);
+            }
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(glm::vec4)*instances, &instanceData[0]);
+        }
+
+        {
+            DebugGroup group("scene");
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glEnable(GL_DEPTH_TEST);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+            // use the shader program
+            glUseProgram(shader_program);
+
+            // calculate ViewProjection matrix
+            glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+            // translate the world/view position
+            glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -8.0f));
+
+            // make the camera rotate around the origin
+            View = glm::rotate(View, 30.0f*std::sin(0.1f*t), glm::vec3(1.0f, 0.0f, 0.0f));
+            View = glm::rotate(View, -22.5f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+            glm::mat4 ViewProjection = Projection*View;
+
+            // set the uniform
+            glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+            // bind the vao and point the instance colors to this frames buffer
+            glBindVertexArray(vao);
+            glBindBuffer(GL_ARRAY_BUFFER, instance_vbo);
+            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 0, (char*)0);
+
+            // draw
+            glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, instances);
+        }
+
+        {
+            DebugGroup group("post");
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            glDisable(GL_DEPTH_TEST);
+            glUseProgram(post_program);
+            glUniform1i(scene_location, 0);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, scene_texture);
+            glBindVertexArray(post_vao);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+        }
+
+        {
+            DebugGroup group("readback");
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            if(bad_usage) {
+                // waits for the frame to finish
+                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &readback[0]);
+            } else {
+                int current = frame%pbocount;
+                // the oldest readback is copied out if it is done,
+                // since the ring is in order that is the slot we reuse
+                if(fences[current]) {
+                    if(glClientWaitSync(fences[current], 0, 0) != GL_TIMEOUT_EXPIRED) {
+                        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[current]);
+                        void *data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.size(), GL_MAP_READ_BIT);
+                        std::memcpy(&readback[0], data, readback.size());
+                        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                    }
+                    glDeleteSync(fences[current]);
+                    fences[current] = 0;
+                }
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[current]);
+                glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                fences[current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            }
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+        }
+        ++frame;
+
+#ifndef NDEBUG
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+#endif
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+    }
+
+#ifndef NDEBUG
+    debug_report.report();
+#endif
+
+    // delete the created objects
+
+    for(int i = 0;i<pbocount;++i)
+        if(fences[i])
+            glDeleteSync(fences[i]);
+    glDeleteBuffers(pbocount, pbos);
+
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteRenderbuffers(1, &scene_depth);
+    glDeleteTextures(1, &scene_texture);
+
+    glDeleteVertexArrays(1, &post_vao);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+    glDeleteBuffers(1, &static_instance_vbo);
+    glDeleteBuffers(1, &stream_instance_vbo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glDetachShader(post_program, post_vertex_shader);
+    glDetachShader(post_program, post_fragment_shader);
+    glDeleteShader(post_vertex_shader);
+    glDeleteShader(post_fragment_shader);
+    glDeleteProgram(post_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
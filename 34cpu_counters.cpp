@@ -0,0 +1,756 @@
+/* OpenGL example code - cpu performance counters
+ *
+ * measures the cpu heavy parts of the other examples with the hardware
+ * performance counters of linux perf_event_open: the chunk meshing of
+ * the queries example, the perlin heightfield of the tesselation example
+ * and the particle update of the buffer mapping example. The counters
+ * (cycles, instructions, cache misses and branch misses) are opened as
+ * one group so a region is measured with a single read before and after.
+ * If the counters are not available (other operating systems, virtual
+ * machines or a restrictive /proc/sys/kernel/perf_event_paranoid) only
+ * the time is reported.
+ *
+ * The particles can be stored as separate position and velocity arrays
+ * like in the buffer mapping example or interleaved in one array of
+ * structs. The counters make the difference in cache behaviour and
+ * instructions per cycle between the two layouts visible.
+ *
+ * toggle the particle layout with space
+ * rerun the meshing and heightfield generation with M
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// the counters we open, the first one is the group leader
+enum Counter { CYCLES, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT };
+const char *counter_names[COUNTER_COUNT] = { "cycles", "instructions", "cache misses", "branch misses" };
+
+struct CounterValues {
+    unsigned long long value[COUNTER_COUNT];
+    double time;
+};
+
+// a group of hardware counters for the calling thread
+class PerfCounters {
+public:
+    PerfCounters() : leader(-1), opened(0)
+    {
+        for(int i = 0;i<COUNTER_COUNT;++i) {
+            fds[i] = -1;
+            slot[i] = -1;
+        }
+#ifdef __linux__
+        const unsigned long long configs[COUNTER_COUNT] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+        };
+        for(int i = 0;i<COUNTER_COUNT;++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.size = sizeof(attr);
+            attr.config = configs[i];
+            attr.disabled = (leader == -1);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+            if(fds[i] < 0) {
+                // without the leader there is no group, missing other
+                // counters (some vms don't expose all) are just skipped
+                if(leader == -1) {
+                    reason = std::strerror(errno);
+                    return;
+                }
+                continue;
+            }
+            if(leader == -1)
+                leader = fds[i];
+            // values of a group read appear in the order of opening
+            slot[i] = opened++;
+        }
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        reason = "perf_event_open is only available on linux";
+#endif
+    }
+
+    ~PerfCounters()
+    {
+#ifdef __linux__
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            if(fds[i] >= 0)
+                close(fds[i]);
+#endif
+    }
+
+    bool available() const { return leader != -1; }
+    bool available(Counter counter) const { return slot[counter] != -1; }
+    const std::string& unavailable_reason() const { return reason; }
+
+    // reads all counters with one syscall, the values are scaled up
+    // if the kernel had to multiplex the counters
+    void read(CounterValues &values) const
+    {
+        values.time = glfwGetTime();
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            values.value[i] = 0;
+#ifdef __linux__
+        if(!available())
+            return;
+        // nr, time_enabled, time_running and one value per counter
+        unsigned long long data[3+COUNTER_COUNT];
+        if(::read(leader, data, sizeof(data)) < ssize_t(3*sizeof(unsigned long long)))
+            return;
+        double scale = data[2] ? double(data[1])/data[2] : 1.0;
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            if(slot[i] != -1)
+                values.value[i] = data[3+slot[i]]*scale;
+#endif
+    }
+
+private:
+    int fds[COUNTER_COUNT], slot[COUNTER_COUNT];
+    int leader, opened;
+    std::string reason;
+};
+
+// accumulated measurements of a named region
+struct RegionStats {
+    RegionStats(const std::string &n) : name(n) { reset(); }
+
+    void reset()
+    {
+        calls = 0;
+        time = 0.0;
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            counters[i] = 0;
+    }
+
+    std::string name;
+    int calls;
+    double time;
+    unsigned long long counters[COUNTER_COUNT];
+};
+
+// measures the scope it lives in and adds the result to a region
+class ScopedCounters {
+public:
+    ScopedCounters(const PerfCounters &c, RegionStats &r) : counters(c), region(r)
+    {
+        counters.read(start);
+    }
+
+    ~ScopedCounters()
+    {
+        CounterValues end;
+        counters.read(end);
+        region.calls += 1;
+        region.time += end.time-start.time;
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            region.counters[i] += end.value[i]-start.value[i];
+    }
+
+private:
+    const PerfCounters &counters;
+    RegionStats &region;
+    CounterValues start;
+};
+
+void print_region(const RegionStats &region, const PerfCounters &counters) {
+    if(region.calls == 0)
+        return;
+    double calls = region.calls;
+    std::cout << std::left << std::setw(28) << region.name << std::right << std::fixed << std::setprecision(3)
+              << std::setw(10) << 1000.0*region.time/calls << " ms";
+    if(counters.available()) {
+        for(int i = 0;i<COUNTER_COUNT;++i) {
+            std::cout << std::setw(12);
+            if(counters.available(Counter(i)))
+                std::cout << std::setprecision(0) << region.counters[i]/calls;
+            else
+                std::cout << "n/a";
+        }
+        if(region.counters[CYCLES] > 0)
+            std::cout << std::setw(8) << std::setprecision(2) << double(region.counters[INSTRUCTIONS])/region.counters[CYCLES];
+    }
+    std::cout << std::endl;
+}
+
+void print_header(const PerfCounters &counters) {
+    std::cout << std::left << std::setw(28) << "region (per call)" << std::right << std::setw(13) << "time";
+    if(counters.available()) {
+        for(int i = 0;i<COUNTER_COUNT;++i)
+            std::cout << std::setw(12) << counter_names[i];
+        std::cout << std::setw(8) << "ipc";
+    }
+    std::cout << std::endl;
+}
+
+// the interleaved particle layout
+struct Particle {
+    glm::vec3 position;
+    glm::vec3 velocity;
+};
+
+glm::vec3 spawn_position() {
+    glm::vec3 pos(0.5f-float(std::rand())/RAND_MAX,
+                  0.5f-float(std::rand())/RAND_MAX,
+                  0.5f-float(std::rand())/RAND_MAX);
+    return glm::vec3(0.0f,20.0f,0.0f) + 5.0f*pos;
+}
+
+// run the heavy startup work of the queries and tesselation examples
+void generate_world(const PerfCounters &counters, RegionStats &meshing, RegionStats &heightfield) {
+    int chunkrange = 2;
+    int chunksize = 32;
+    size_t quads = 0;
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        std::vector<glm::vec3> vertexData;
+        glm::vec3 offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        ScopedCounters scope(counters, meshing);
+        generate_chunk(offset, chunksize, vertexData);
+        quads += vertexData.size()/8;
+    }
+
+    const int terrainsize = 1024;
+    std::vector<GLfloat> displacementData(terrainsize*terrainsize*3);
+    {
+        ScopedCounters scope(counters, heightfield);
+        for(int y = 0;y<terrainsize;++y) {
+            for(int x = 0;x<terrainsize;++x) {
+                glm::vec2 pos(x, y);
+                displacementData[3*(y*terrainsize+x)+0] = 0.0f;
+                displacementData[3*(y*terrainsize+x)+1] = 20.0f*glm::perlin(0.01f*pos);
+                displacementData[3*(y*terrainsize+x)+2] = 0.0f;
+            }
+        }
+    }
+    std::cout << "meshed " << quads << " quads, generated a " << terrainsize << "x" << terrainsize << " heightfield" << std::endl;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "34cpu_counters", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // open the counters for this thread
+    PerfCounters counters;
+    if(!counters.available())
+        std::cout << "hardware counters unavailable (" << counters.unavailable_reason() << "), reporting time only" << std::endl;
+
+    RegionStats meshing("chunk meshing");
+    RegionStats heightfield("heightfield generation");
+    RegionStats separate_update("particles (separate arrays)");
+    RegionStats interleaved_update("particles (interleaved)");
+    RegionStats upload("particle upload");
+
+    std::cout << "generating chunks and heightfield, this may take a while." << std::endl;
+    generate_world(counters, meshing, heightfield);
+    print_header(counters);
+    print_region(meshing, counters);
+    print_region(heightfield, counters);
+
+    // the vertex shader simply passes through data
+    std::string vertex_source =
+        "#version 330\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "void main() {\n"
+        "   gl_Position = vposition;\n"
+        "}\n";
+
+    // the geometry shader creates the billboard quads
+    std::string geometry_source =
+        "#version 330\n"
+        "uniform mat4 View;\n"
+        "uniform mat4 Projection;\n"
+        "layout (points) in;\n"
+        "layout (triangle_strip, max_vertices = 4) out;\n"
+        "out vec2 txcoord;\n"
+        "void main() {\n"
+        "   vec4 pos = View*gl_in[0].gl_Position;\n"
+        "   txcoord = vec2(-1,-1);\n"
+        "   gl_Position = Projection*(pos+0.2*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1,-1);\n"
+        "   gl_Position = Projection*(pos+0.2*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2(-1, 1);\n"
+        "   gl_Position = Projection*(pos+0.2*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "   txcoord = vec2( 1, 1);\n"
+        "   gl_Position = Projection*(pos+0.2*vec4(txcoord,0,0));\n"
+        "   EmitVertex();\n"
+        "}\n";
+
+    // the fragment shader creates a bell like radial color distribution
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec2 txcoord;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   float s = 0.2*(1/(1+15.*dot(txcoord, txcoord))-1/16.);\n"
+        "   FragColor = s*vec4(0.3,0.3,1.0,1);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, geometry_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length); 
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+    
+    // create and compiler geometry shader
+    geometry_shader = glCreateShader(GL_GEOMETRY_SHADER);
+    source = geometry_source.c_str();
+    length = geometry_source.size();
+    glShaderSource(geometry_shader, 1, &source, &length); 
+    glCompileShader(geometry_shader);
+    if(!check_shader_compile_status(geometry_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+ 
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);   
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+    
+    // create program
+    shader_program = glCreateProgram();
+    
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, geometry_shader);
+    glAttachShader(shader_program, fragment_shader);
+    
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint View_location = glGetUniformLocation(shader_program, "View");
+    GLint Projection_location = glGetUniformLocation(shader_program, "Projection");
+
+    const int particles = 128*1024;
+
+    // randomly place particles in a cube, both layouts are kept so
+    // switching doesn't need a conversion
+    std::vector<glm::vec3> vertexData(particles);
+    std::vector<glm::vec3> velocity(particles);
+    std::vector<Particle> particleData(particles);
+    for(int i = 0;i<particles;++i) {
+        vertexData[i] = spawn_position();
+        particleData[i].position = vertexData[i];
+        particleData[i].velocity = glm::vec3(0,0,0);
+    }
+
+    const int buffercount = 3;
+    // generate vbos and vaos
+    GLuint vao[buffercount], vbo[buffercount];
+    glGenVertexArrays(buffercount, vao);
+    glGenBuffers(buffercount, vbo);
+
+    for(int i = 0;i<buffercount;++i) {
+        glBindVertexArray(vao[i]);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo[i]);
+
+        // fill with initial data
+        glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), &vertexData[0], GL_DYNAMIC_DRAW);
+
+        // set up generic attrib pointers
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+    }
+
+    // we are blending so no depth testing
+    glDisable(GL_DEPTH_TEST);
+
+    // enable blending
+    glEnable(GL_BLEND);
+    //  and set the blend function to result = 1*source + 1*destination
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    // define spheres for the particles to bounce off
+    const int spheres = 3;
+    glm::vec3 center[spheres];
+    float radius[spheres];
+    center[0] = glm::vec3(0,12,1);
+    radius[0] = 3;
+    center[1] = glm::vec3(-3,0,0);
+    radius[1] = 7;
+    center[2] = glm::vec3(5,-10,0);
+    radius[2] = 12;
+
+    // physical parameters
+    float dt = 1.0f/60.0f;
+    glm::vec3 g(0.0f, -9.81f, 0.0f);
+    float bounce = 1.2f; // inelastic: 1.0f, elastic: 2.0f
+
+    bool interleaved = false;
+    bool space_down = false;
+    bool m_down = false;
+    double last_report = glfwGetTime();
+
+    int current_buffer=0;
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // toggle the particle layout
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            interleaved = !interleaved;
+            for(int i = 0;i<particles;++i) {
+                if(interleaved) {
+                    particleData[i].position = vertexData[i];
+                    particleData[i].velocity = velocity[i];
+                } else {
+                    vertexData[i] = particleData[i].position;
+                    velocity[i] = particleData[i].velocity;
+                }
+            }
+            std::cout << (interleaved?"interleaved":"separate") << " particle layout" << std::endl;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        // rerun the startup work
+        if(glfwGetKey(window, 'M') && !m_down) {
+            meshing.reset();
+            heightfield.reset();
+            generate_world(counters, meshing, heightfield);
+            print_region(meshing, counters);
+            print_region(heightfield, counters);
+        }
+        m_down = glfwGetKey(window, 'M');
+
+        // update physics
+        if(!interleaved) {
+            ScopedCounters scope(counters, separate_update);
+            for(int i = 0;i<particles;++i) {
+                // resolve sphere collisions
+                for(int j = 0;j<spheres;++j) {
+                    glm::vec3 diff = vertexData[i]-center[j];
+                    float dist = glm::length(diff);
+                    if(dist<radius[j] && glm::dot(diff, velocity[i])<0.0f)
+                        velocity[i] -= bounce*diff/(dist*dist)*glm::dot(diff, velocity[i]);
+                }
+                // euler iteration
+                velocity[i] += dt*g;
+                vertexData[i] += dt*velocity[i];
+                // reset particles that fall out to a starting position
+                if(vertexData[i].y<-30.0) {
+                    vertexData[i] = spawn_position();
+                    velocity[i] = glm::vec3(0,0,0);
+                }
+            }
+        } else {
+            ScopedCounters scope(counters, interleaved_update);
+            for(int i = 0;i<particles;++i) {
+                Particle &p = particleData[i];
+                // resolve sphere collisions
+                for(int j = 0;j<spheres;++j) {
+                    glm::vec3 diff = p.position-center[j];
+                    float dist = glm::length(diff);
+                    if(dist<radius[j] && glm::dot(diff, p.velocity)<0.0f)
+                        p.velocity -= bounce*diff/(dist*dist)*glm::dot(diff, p.velocity);
+                }
+                // euler iteration
+                p.velocity += dt*g;
+                p.position += dt*p.velocity;
+                // reset particles that fall out to a starting position
+                if(p.position.y<-30.0) {
+                    p.position = spawn_position();
+                    p.velocity = glm::vec3(0,0,0);
+                }
+            }
+        }
+
+        {
+            ScopedCounters scope(counters, upload);
+
+            // bind a buffer to upload to
+            glBindBuffer(GL_ARRAY_BUFFER, vbo[(current_buffer+buffercount-1)%buffercount]);
+
+            // explicitly invalidate the buffer
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*particles, 0, GL_DYNAMIC_DRAW);
+
+            // map the buffer
+            glm::vec3 *mapped =
+                reinterpret_cast<glm::vec3*>(
+                    glMapBufferRange(GL_ARRAY_BUFFER, 0,
+                        sizeof(glm::vec3)*particles,
+                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+                    )
+                );
+
+            // copy data into the mapped memory, the interleaved layout
+            // has to gather the positions
+            if(!interleaved) {
+                std::copy(vertexData.begin(), vertexData.end(), mapped);
+            } else {
+                for(int i = 0;i<particles;++i)
+                    mapped[i] = particleData[i].position;
+            }
+
+            // unmap the buffer
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+
+        // clear first
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(90.0f, 4.0f / 3.0f, 0.1f, 100.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -30.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 30.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, -22.5f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        // set the uniform
+        glUniformMatrix4fv(View_location, 1, GL_FALSE, glm::value_ptr(View));
+        glUniformMatrix4fv(Projection_location, 1, GL_FALSE, glm::value_ptr(Projection));
+
+        // bind the current vao
+        glBindVertexArray(vao[current_buffer]);
+
+        // draw
+        glDrawArrays(GL_POINTS, 0, particles);
+
+        // report the per frame regions every two seconds
+        if(t-last_report > 2.0) {
+            print_header(counters);
+            print_region(separate_update, counters);
+            print_region(interleaved_update, counters);
+            print_region(upload, counters);
+            separate_update.reset();
+            interleaved_update.reset();
+            upload.reset();
+            last_report = t;
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        // advance buffer index
+        current_buffer = (current_buffer + 1) % buffercount;
+    }
+
+    // delete the created objects
+
+    glDeleteVertexArrays(buffercount, vao);
+    glDeleteBuffers(buffercount, vbo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, geometry_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(geometry_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,857 @@
+/* OpenGL example code - metrics endpoint
+ *
+ * This example renders the voxel landscape of the queries example and
+ * records its performance into an in-process metrics registry instead
+ * of printing a line per frame. Frame, cpu and gpu times go into
+ * latency histograms with log-linear buckets (like HdrHistogram, every
+ * power of two is split into 16 linear buckets so the relative error
+ * stays below 1/16) and the draw calls, culled chunks and uploaded
+ * bytes are counted. All metrics are plain atomics that are registered
+ * before the first frame, so recording doesn't lock or allocate on the
+ * render thread.
+ * A background thread serves the registry in the prometheus text format
+ * over http. By default it listens on 127.0.0.1:9100, a port or the path
+ * of a unix socket can be given as argument:
+ *
+ *     35metrics_endpoint 9200
+ *     curl http://127.0.0.1:9200/metrics
+ *
+ *     35metrics_endpoint /tmp/metrics.sock
+ *     curl --unix-socket /tmp/metrics.sock http://localhost/metrics
+ *
+ * The chunks are generated one per frame nearest first, so the frame
+ * time histogram shows the spikes of the streaming.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_SOCKETS
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+// chunk data structure that contains the information required to
+// render and cull the chunks
+struct Chunk {
+    GLuint vbo, ibo, vao;
+    int quadcount;
+    glm::vec3 offset;
+    glm::vec3 center;
+};
+
+// predicate to allow sorting chunks by distance from a point
+class DistancePred {
+public:
+    DistancePred(glm::vec3 p) : pos(p) { }
+    bool operator()(const Chunk &a, const Chunk &b) {
+        return glm::distance(pos, a.center) < glm::distance(pos, b.center);
+    }
+private:
+    const glm::vec3 pos;
+};
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// a monotonically increasing counter
+class CounterMetric {
+public:
+    CounterMetric(const std::string &n, const std::string &h) : name(n), help(h), value(0) { }
+
+    void add(uint64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+
+    void write(std::ostream &out) const
+    {
+        out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " counter\n";
+        out << name << " " << value.load(std::memory_order_relaxed) << "\n";
+    }
+
+private:
+    std::string name, help;
+    std::atomic<uint64_t> value;
+};
+
+// latency histogram with log-linear buckets of microseconds. Values
+// below subbuckets get a bucket each, above that every power of two is
+// split into subbuckets buckets.
+class HistogramMetric {
+public:
+    static const int subbucket_bits = 4;
+    static const int subbuckets = 1<<subbucket_bits;
+    static const int maxshift = 32;
+    static const int bucketcount = (maxshift+2)*subbuckets;
+
+    HistogramMetric(const std::string &n, const std::string &h) : name(n), help(h), sum(0)
+    {
+        for(int i = 0;i<bucketcount;++i)
+            buckets[i].store(0);
+    }
+
+    void record(double seconds)
+    {
+        uint64_t us = seconds > 0.0 ? uint64_t(seconds*1e6) : 0;
+        buckets[bucket_index(us)].fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    // the value below which the given fraction of the recorded values are
+    double quantile(double q) const
+    {
+        uint64_t counts[bucketcount];
+        uint64_t total = snapshot(counts);
+        uint64_t rank = uint64_t(q*total), seen = 0;
+        for(int i = 0;i<bucketcount;++i) {
+            seen += counts[i];
+            if(seen > rank)
+                return 1e-6*bucket_upper(i);
+        }
+        return 0.0;
+    }
+
+    // prometheus wants cumulative counts for fixed boundaries, the hdr
+    // buckets are summed up to the boundaries. A bucket that straddles a
+    // boundary is counted in the next one, so the counts are exact to the
+    // bucket resolution.
+    void write(std::ostream &out) const
+    {
+        static const double bounds[] = {
+            0.0005, 0.001, 0.002, 0.004, 0.008, 0.0167, 0.0333, 0.05, 0.1, 0.25, 0.5, 1.0
+        };
+        const int boundcount = sizeof(bounds)/sizeof(bounds[0]);
+
+        uint64_t counts[bucketcount];
+        uint64_t total = snapshot(counts);
+
+        out << "# HELP " << name << " " << help << "\n";
+        out << "# TYPE " << name << " histogram\n";
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for(int b = 0;b<boundcount;++b) {
+            uint64_t bound = uint64_t(bounds[b]*1e6);
+            // a bucket contains the values [lower, upper)
+            for(;bucket<bucketcount && bucket_upper(bucket)-1 <= bound;++bucket)
+                cumulative += counts[bucket];
+            out << name << "_bucket{le=\"" << bounds[b] << "\"} " << cumulative << "\n";
+        }
+        out << name << "_bucket{le=\"+Inf\"} " << total << "\n";
+        out << name << "_sum " << 1e-6*sum.load(std::memory_order_relaxed) << "\n";
+        out << name << "_count " << total << "\n";
+    }
+
+private:
+    static int bucket_index(uint64_t value)
+    {
+        int shift = 0;
+        while((value >> shift) >= 2*subbuckets && shift < maxshift)
+            ++shift;
+        if(shift == 0)
+            return int(std::min<uint64_t>(value, 2*subbuckets-1));
+        uint64_t sub = std::min<uint64_t>(value >> shift, 2*subbuckets-1);
+        return (shift+1)*subbuckets + int(sub-subbuckets);
+    }
+
+    // exclusive upper bound of a bucket
+    static uint64_t bucket_upper(int index)
+    {
+        if(index < 2*subbuckets)
+            return index+1;
+        int shift = index/subbuckets-1;
+        uint64_t sub = index%subbuckets + subbuckets;
+        return (sub+1) << shift;
+    }
+
+    // copies the buckets, the total is taken from the copy so it is
+    // consistent with the buckets even while the render thread records
+    uint64_t snapshot(uint64_t *counts) const
+    {
+        uint64_t total = 0;
+        for(int i = 0;i<bucketcount;++i) {
+            counts[i] = buckets[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        return total;
+    }
+
+    std::string name, help;
+    std::atomic<uint64_t> buckets[bucketcount];
+    std::atomic<uint64_t> sum;
+};
+
+// owns all metrics. Metrics have to be added before the server starts,
+// after that the containers are only read.
+class MetricsRegistry {
+public:
+    ~MetricsRegistry()
+    {
+        for(size_t i = 0;i<counters.size();++i)
+            delete counters[i];
+        for(size_t i = 0;i<histograms.size();++i)
+            delete histograms[i];
+    }
+
+    CounterMetric& counter(const std::string &name, const std::string &help)
+    {
+        counters.push_back(new CounterMetric(name, help));
+        return *counters.back();
+    }
+
+    HistogramMetric& histogram(const std::string &name, const std::string &help)
+    {
+        histograms.push_back(new HistogramMetric(name, help));
+        return *histograms.back();
+    }
+
+    std::string exposition() const
+    {
+        std::ostringstream out;
+        out.precision(12);
+        for(size_t i = 0;i<counters.size();++i)
+            counters[i]->write(out);
+        for(size_t i = 0;i<histograms.size();++i)
+            histograms[i]->write(out);
+        return out.str();
+    }
+
+private:
+    std::vector<CounterMetric*> counters;
+    std::vector<HistogramMetric*> histograms;
+};
+
+// serves the registry over http from a background thread. The address
+// is either a tcp port on the loopback interface or a unix socket path.
+class MetricsServer {
+public:
+    MetricsServer(const MetricsRegistry &r) : registry(r), fd(-1), running(false) { }
+
+    ~MetricsServer()
+    {
+        stop();
+    }
+
+    bool start(const std::string &address)
+    {
+#ifdef HAVE_SOCKETS
+        if(!address.empty() && address[0] == '/') {
+            sockaddr_un addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sun_family = AF_UNIX;
+            if(address.size() >= sizeof(addr.sun_path))
+                return false;
+            std::strcpy(addr.sun_path, address.c_str());
+            // only replace a stale socket, never some other file
+            struct stat info;
+            if(lstat(address.c_str(), &info) == 0) {
+                if(!S_ISSOCK(info.st_mode))
+                    return false;
+                unlink(address.c_str());
+            }
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if(fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                stop();
+                return false;
+            }
+            path = address;
+        } else {
+            char *end;
+            long port = std::strtol(address.c_str(), &end, 10);
+            if(address.empty() || *end != '\0' || port < 1 || port > 65535)
+                return false;
+            sockaddr_in addr;
+            std::memset(&addr, 0, sizeof(addr));
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            int reuse = 1;
+            if(fd >= 0)
+                setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+            if(fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                stop();
+                return false;
+            }
+        }
+        if(listen(fd, 4) != 0) {
+            stop();
+            return false;
+        }
+        running = true;
+        thread = std::thread(&MetricsServer::run, this);
+        return true;
+#else
+        (void)address;
+        return false;
+#endif
+    }
+
+    void stop()
+    {
+        running = false;
+        if(thread.joinable())
+            thread.join();
+#ifdef HAVE_SOCKETS
+        if(fd >= 0)
+            close(fd);
+        if(!path.empty())
+            unlink(path.c_str());
+#endif
+        fd = -1;
+        path.clear();
+    }
+
+private:
+    void run()
+    {
+#ifdef HAVE_SOCKETS
+        while(running) {
+            // wake up regularly to notice when we are stopped
+            pollfd pfd;
+            pfd.fd = fd;
+            pfd.events = POLLIN;
+            if(poll(&pfd, 1, 100) <= 0)
+                continue;
+            int client = accept(fd, 0, 0);
+            if(client < 0)
+                continue;
+            serve(client);
+            close(client);
+        }
+#endif
+    }
+
+#ifdef HAVE_SOCKETS
+    void serve(int client)
+    {
+        // read the request header, we only look at the request line
+        std::string request;
+        char buffer[512];
+        while(request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+            pollfd pfd;
+            pfd.fd = client;
+            pfd.events = POLLIN;
+            if(poll(&pfd, 1, 1000) <= 0)
+                return;
+            ssize_t n = recv(client, buffer, sizeof(buffer), 0);
+            if(n <= 0)
+                return;
+            request.append(buffer, n);
+        }
+
+        std::string status, body;
+        if(request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 6, "GET / ") == 0) {
+            status = "200 OK";
+            body = registry.exposition();
+        } else {
+            status = "404 Not Found";
+            body = "only /metrics is served\n";
+        }
+
+        std::ostringstream response;
+        response << "HTTP/1.0 " << status << "\r\n"
+                 << "Content-Type: text/plain; version=0.0.4\r\n"
+                 << "Content-Length: " << body.size() << "\r\n"
+                 << "Connection: close\r\n\r\n" << body;
+        std::string data = response.str();
+        size_t sent = 0;
+        while(sent < data.size()) {
+            ssize_t n = send(client, data.data()+sent, data.size()-sent, MSG_NOSIGNAL);
+            if(n <= 0)
+                return;
+            sent += n;
+        }
+    }
+#endif
+
+    const MetricsRegistry &registry;
+    int fd;
+    std::string path;
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+
+int main(int argc, char *argv[]) {
+    int width = 640;
+    int height = 480;
+
+    std::string address = argc>1 ? argv[1] : "9100";
+
+    // register all metrics before anything can read them
+    MetricsRegistry registry;
+    CounterMetric &frames = registry.counter("render_frames_total", "Number of rendered frames.");
+    CounterMetric &draws = registry.counter("render_draw_calls_total", "Number of draw calls issued.");
+    CounterMetric &culled = registry.counter("render_chunks_culled_total", "Number of chunks skipped by frustum culling.");
+    CounterMetric &uploaded = registry.counter("render_uploaded_bytes_total", "Number of bytes uploaded to buffer objects.");
+    HistogramMetric &frame_time = registry.histogram("render_frame_seconds", "Time between two buffer swaps.");
+    HistogramMetric &cpu_time = registry.histogram("render_cpu_seconds", "Cpu time spent on a frame before the swap.");
+    HistogramMetric &gpu_time = registry.histogram("render_gpu_seconds", "Gpu time of a frame measured with timer queries.");
+
+    MetricsServer server(registry);
+    if(server.start(address))
+        std::cout << "serving metrics on " << (address[0] == '/' ? "unix:" : "http://127.0.0.1:") << address << (address[0] == '/' ? "" : "/metrics") << std::endl;
+    else
+        std::cerr << "failed to serve metrics on " << address << ", recording only" << std::endl;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "35metrics_endpoint", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // draw shader
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = abs(fcolor);\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of projection uniform
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+
+    // chunk container and chunk parameters, the chunks start out empty
+    // and are generated while rendering
+    std::vector<Chunk> chunks;
+    std::vector<Chunk> pending;
+    int chunkrange = 4;
+    int chunksize = 32;
+
+    for(int i = -chunkrange;i<chunkrange;++i)
+        for(int j = -chunkrange;j<chunkrange;++j)
+            for(int k = -chunkrange;k<chunkrange;++k) {
+        Chunk chunk;
+        chunk.vao = chunk.vbo = chunk.ibo = 0;
+        chunk.quadcount = 0;
+        chunk.offset = static_cast<float>(chunksize) * glm::vec3(i,j,k);
+        chunk.center = chunk.offset + 0.5f*chunksize;
+        pending.push_back(chunk);
+    }
+
+    // timer query setup
+    // use multiple queries to avoid stalling on getting the results
+    const int querycount = 5;
+    GLuint queries[querycount];
+    int current_query = 0;
+    glGenQueries(querycount, queries);
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // camera position and orientation
+    glm::vec3 position;
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    float t = glfwGetTime();
+    double last_swap = glfwGetTime();
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+    while(!glfwWindowShouldClose(window)) {
+        double frame_start = glfwGetTime();
+        glfwPollEvents();
+
+        // calculate timestep
+        float new_t = glfwGetTime();
+        float dt = new_t - t;
+        t = new_t;
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 10.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 10.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 10.0f*dt*right;
+        }
+
+        // generate and upload the nearest pending chunk
+        if(!pending.empty()) {
+            std::vector<Chunk>::iterator nearest = std::min_element(pending.begin(), pending.end(), DistancePred(position));
+            Chunk chunk = *nearest;
+            pending.erase(nearest);
+
+            std::vector<glm::vec3> vertexData;
+            generate_chunk(chunk.offset, chunksize, vertexData);
+            chunk.quadcount = vertexData.size()/8;
+
+            if(chunk.quadcount > 0) {
+                // generate and bind the vao
+                glGenVertexArrays(1, &chunk.vao);
+                glBindVertexArray(chunk.vao);
+
+                // generate and bind the vertex buffer object
+                glGenBuffers(1, &chunk.vbo);
+                glBindBuffer(GL_ARRAY_BUFFER, chunk.vbo);
+
+                // upload
+                glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), &vertexData[0], GL_STATIC_DRAW);
+                uploaded.add(sizeof(glm::vec3)*vertexData.size());
+
+                // set up generic attrib pointers
+                glEnableVertexAttribArray(0);
+                glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+                glEnableVertexAttribArray(1);
+                glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+                // generate and bind the index buffer object
+                glGenBuffers(1, &chunk.ibo);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.ibo);
+
+                std::vector<GLuint> indexData(6*chunk.quadcount);
+                for(int i = 0;i<chunk.quadcount;++i) {
+                    indexData[6*i + 0] = 4*i + 0;
+                    indexData[6*i + 1] = 4*i + 1;
+                    indexData[6*i + 2] = 4*i + 2;
+                    indexData[6*i + 3] = 4*i + 2;
+                    indexData[6*i + 4] = 4*i + 1;
+                    indexData[6*i + 5] = 4*i + 3;
+                }
+
+                // upload
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), &indexData[0], GL_STATIC_DRAW);
+                uploaded.add(sizeof(GLuint)*indexData.size());
+
+                chunks.push_back(chunk);
+            }
+        }
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 0.1f, 200.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set clear color to sky blue
+        glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // start timer query
+        glBeginQuery(GL_TIME_ELAPSED, queries[current_query]);
+
+        glUseProgram(shader_program);
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+
+        for(size_t i = 0;i<chunks.size();++i) {
+            // frustum culling
+            glm::vec4 projected = ViewProjection*glm::vec4(chunks[i].center,1);
+            if( (glm::distance(chunks[i].center,position) > chunksize) &&
+                (std::max(std::abs(projected.x), std::abs(projected.y)) > projected.w+chunksize)) {
+                culled.add(1);
+                continue;
+            }
+
+            // draw chunk
+            glBindVertexArray(chunks[i].vao);
+            glDrawElements(GL_TRIANGLES, 6*chunks[i].quadcount, GL_UNSIGNED_INT, 0);
+            draws.add(1);
+        }
+
+        // end timer query
+        glEndQuery(GL_TIME_ELAPSED);
+
+        // record the oldest query once its result is available
+        int oldest_query = (current_query+1)%querycount;
+        if(glIsQuery(queries[oldest_query])) {
+            GLuint64 result;
+            glGetQueryObjectui64v(queries[oldest_query], GL_QUERY_RESULT, &result);
+            gpu_time.record(1e-9*result);
+        }
+        current_query = oldest_query;
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        cpu_time.record(glfwGetTime()-frame_start);
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        double now = glfwGetTime();
+        frame_time.record(now-last_swap);
+        last_swap = now;
+        frames.add(1);
+    }
+
+    server.stop();
+
+    std::cout << "frame time p50 " << 1000.0*frame_time.quantile(0.5) << " ms, p99 "
+              << 1000.0*frame_time.quantile(0.99) << " ms, p99.9 "
+              << 1000.0*frame_time.quantile(0.999) << " ms" << std::endl;
+
+    // delete the created objects
+    for(size_t i = 0;i<chunks.size();++i) {
+        glDeleteVertexArrays(1, &chunks[i].vao);
+        glDeleteBuffers(1, &chunks[i].vbo);
+        glDeleteBuffers(1, &chunks[i].ibo);
+    }
+
+    glDeleteQueries(querycount, queries);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,791 @@
+/* OpenGL example code - startup phases
+ *
+ * This example measures where the startup time of a heavier example
+ * goes and shows how to get the first frame on screen sooner. The
+ * scene combines the data sets of the other examples: the voxel chunks
+ * of the queries example, a 1024x1024 perlin heightfield like in the
+ * tesselation example and 128K random particles.
+ * Every phase (context creation, shader compiles, data generation and
+ * uploads) is recorded with the thread it ran on and printed as a
+ * timeline once the scene is complete.
+ *
+ * By default everything happens before the first frame like in the other
+ * examples. With --fast the first frame is presented right after context
+ * creation and a progress bar is shown while worker threads generate the
+ * data. The shaders are compiled in the meantime, if
+ * GL_KHR_parallel_shader_compile is available the driver compiles them
+ * in the background and we only poll for completion. Each data set is
+ * uploaded and drawn as soon as it and its program are ready.
+ *
+ *     36startup_phases
+ *     36startup_phases --fast
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <cstring>
+
+// world function that defines the voxel data
+float world_function(glm::vec3 pos) {
+    return glm::perlin(0.1f*(pos+glm::vec3(100,100,100)));
+}
+
+// extract the quads of one chunk, same as in the queries example
+void generate_chunk(glm::vec3 offset, int chunksize, std::vector<glm::vec3> &vertexData) {
+    float threshold = 0.0f;
+    // iterate over all blocks within the chunk
+    for(int x = 0;x<chunksize;++x) {
+        for(int y = 0;y<chunksize;++y)  {
+            for(int z = 0;z<chunksize;++z) {
+                glm::vec3 pos = glm::vec3(x,y,z) + offset;
+                // insert quads if current block is solid and neighbors are not
+                if(world_function(pos)<threshold) {
+                    if(world_function(pos+glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 1, 0, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 1, 0));
+                    }
+                    if(world_function(pos+glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0, 0, 1));
+                    }
+                    if(world_function(pos-glm::vec3(1,0,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3(-1, 0, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,1,0))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1, 1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0,-1, 0));
+                    }
+                    if(world_function(pos-glm::vec3(0,0,1))>=threshold) {
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3( 1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1, 1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                        vertexData.push_back(pos+0.5f*glm::vec3(-1,-1,-1));
+                        vertexData.push_back(glm::vec3( 0, 0,-1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+// records named phases relative to the start of the program, phases
+// can be recorded from any thread
+class StartupPhases {
+public:
+    StartupPhases() : origin(std::chrono::steady_clock::now()) { }
+
+    int begin(const std::string &name, const std::string &thread)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Phase phase = { name, thread, now(), -1.0 };
+        phases.push_back(phase);
+        return phases.size()-1;
+    }
+
+    void end(int index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        phases[index].end = now();
+    }
+
+    // a point in time like the first presented frame
+    void mark(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Phase phase = { name, "", now(), now() };
+        marks.push_back(phase);
+    }
+
+    // phases that are still running are listed as open and their bar
+    // extends to the end of the chart
+    void report(const std::string &title)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        double total = 0.0;
+        for(size_t i = 0;i<phases.size();++i)
+            total = std::max(total, std::max(phases[i].start, phases[i].end));
+        for(size_t i = 0;i<marks.size();++i)
+            total = std::max(total, marks[i].end);
+
+        const int barwidth = 40;
+        std::cout << title << std::endl;
+        std::cout << std::left << std::setw(24) << "phase" << std::setw(10) << "thread" << std::right
+                  << std::setw(10) << "start ms" << std::setw(10) << "ms" << std::endl;
+        for(size_t i = 0;i<phases.size();++i) {
+            const Phase &phase = phases[i];
+            bool open = phase.end < 0.0;
+            int from = std::min(barwidth-1, int(barwidth*phase.start/total));
+            int to = open ? barwidth : std::max(from+1, int(barwidth*phase.end/total));
+            std::cout << std::left << std::setw(24) << phase.name << std::setw(10) << phase.thread << std::right
+                      << std::fixed << std::setprecision(1) << std::setw(10) << 1000.0*phase.start;
+            if(open)
+                std::cout << std::setw(10) << "open";
+            else
+                std::cout << std::setw(10) << 1000.0*(phase.end-phase.start);
+            std::cout << "  |" << std::string(from, ' ') << std::string(to-from, '#')
+                      << std::string(std::max(0, barwidth-to), ' ') << "|" << std::endl;
+        }
+        for(size_t i = 0;i<marks.size();++i)
+            std::cout << marks[i].name << " after " << 1000.0*marks[i].start << " ms" << std::endl;
+    }
+
+private:
+    struct Phase {
+        std::string name, thread;
+        double start, end;
+    };
+
+    double now() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now()-origin).count();
+    }
+
+    std::chrono::steady_clock::time_point origin;
+    std::vector<Phase> phases, marks;
+    std::mutex mutex;
+};
+
+// records the scope it lives in as a phase
+class ScopedPhase {
+public:
+    ScopedPhase(StartupPhases &p, const std::string &name, const std::string &thread) : phases(p)
+    {
+        index = phases.begin(name, thread);
+    }
+
+    ~ScopedPhase()
+    {
+        phases.end(index);
+    }
+
+private:
+    StartupPhases &phases;
+    int index;
+};
+
+const int chunkrange = 2;
+const int chunksize = 32;
+const int terrainsize = 1024;
+const int particles = 128*1024;
+
+// the cpu side data, the flags tell the render thread which parts are done
+struct SceneData {
+    SceneData() : chunks(8*chunkrange*chunkrange*chunkrange), next_chunk(0), chunks_done(0),
+                  terrain_done(false), particles_done(false), cancel(false) { }
+
+    std::vector< std::vector<glm::vec3> > chunks;
+    std::vector<GLfloat> terrain;
+    std::vector<glm::vec3> particles;
+
+    std::atomic<int> next_chunk, chunks_done;
+    std::atomic<bool> terrain_done, particles_done;
+
+    // set when the program exits before the workers are done
+    std::atomic<bool> cancel;
+};
+
+// meshes chunks until there are none left, several threads can share the work
+void mesh_chunks(SceneData &scene, StartupPhases &phases, const std::string &thread) {
+    ScopedPhase phase(phases, "chunk meshing", thread);
+    int count = scene.chunks.size();
+    for(int index = scene.next_chunk++;index<count && !scene.cancel;index = scene.next_chunk++) {
+        int side = 2*chunkrange;
+        glm::vec3 cell(index%side, (index/side)%side, index/(side*side));
+        glm::vec3 offset = static_cast<float>(chunksize) * (cell-glm::vec3(chunkrange));
+        generate_chunk(offset, chunksize, scene.chunks[index]);
+        ++scene.chunks_done;
+    }
+}
+
+void generate_terrain(SceneData &scene, StartupPhases &phases, const std::string &thread) {
+    ScopedPhase phase(phases, "terrain generation", thread);
+    scene.terrain.resize(terrainsize*terrainsize);
+    for(int y = 0;y<terrainsize;++y) {
+        if(scene.cancel)
+            return;
+        for(int x = 0;x<terrainsize;++x)
+            scene.terrain[y*terrainsize+x] = 20.0f*glm::perlin(0.01f*glm::vec2(x, y));
+    }
+    scene.terrain_done = true;
+}
+
+void generate_particles(SceneData &scene, StartupPhases &phases, const std::string &thread) {
+    ScopedPhase phase(phases, "particle generation", thread);
+    scene.particles.resize(particles);
+    // std::rand is not thread safe, use a simple xorshift instead
+    unsigned state = 2463534242u;
+    for(int i = 0;i<particles;++i) {
+        float value[3];
+        for(int j = 0;j<3;++j) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            value[j] = float(state)/4294967295.0f;
+        }
+        scene.particles[i] = glm::vec3(200.0f*value[0]-100.0f, 40.0f+80.0f*value[1], 200.0f*value[2]-100.0f);
+    }
+    scene.particles_done = true;
+}
+
+bool has_extension(const char *name) {
+    GLint count;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i = 0;i<count;++i)
+        if(std::strcmp(name, reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i))) == 0)
+            return true;
+    return false;
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+
+// shader program that can be compiled without waiting for the result
+struct Program {
+    GLuint program, vertex_shader, fragment_shader;
+    GLint ViewProjection_location;
+    int phase;
+    bool started, linked;
+};
+
+// starts compiling and linking, the status is only checked once the
+// program is complete so the driver doesn't have to finish right away
+void start_program(Program &p, const std::string &vertex_source, const std::string &fragment_source) {
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    p.vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(p.vertex_shader, 1, &source, &length);
+    glCompileShader(p.vertex_shader);
+
+    // create and compiler fragment shader
+    p.fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(p.fragment_shader, 1, &source, &length);
+    glCompileShader(p.fragment_shader);
+
+    // create program
+    p.program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(p.program, p.vertex_shader);
+    glAttachShader(p.program, p.fragment_shader);
+
+    // link the program
+    glLinkProgram(p.program);
+    p.started = true;
+}
+
+// with parallel compile we can ask if the program is done without blocking
+bool program_complete(const Program &p, bool parallel) {
+    if(!parallel)
+        return true;
+    GLint complete;
+    glGetProgramiv(p.program, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+// checks for errors and obtains the uniform location once the program is done
+bool finish_program(Program &p) {
+    if(!check_shader_compile_status(p.vertex_shader) ||
+       !check_shader_compile_status(p.fragment_shader) ||
+       !check_program_link_status(p.program))
+        return false;
+    p.ViewProjection_location = glGetUniformLocation(p.program, "ViewProjection");
+    p.linked = true;
+    return true;
+}
+
+void delete_program(const Program &p) {
+    if(!p.started)
+        return;
+    glDetachShader(p.program, p.vertex_shader);
+    glDetachShader(p.program, p.fragment_shader);
+    glDeleteShader(p.vertex_shader);
+    glDeleteShader(p.fragment_shader);
+    glDeleteProgram(p.program);
+}
+
+int main(int argc, char *argv[]) {
+    StartupPhases phases;
+    bool fast = argc>1 && std::string(argv[1]) == "--fast";
+
+    int width = 640;
+    int height = 480;
+
+    int phase = phases.begin("glfw init", "main");
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+    phases.end(phase);
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    phase = phases.begin("window and context", "main");
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "36startup_phases", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+    phases.end(phase);
+
+    phase = phases.begin("gl function loading", "main");
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+    phases.end(phase);
+
+    // let the driver compile on its own threads if it can
+    bool parallel_compile = has_extension("GL_KHR_parallel_shader_compile");
+    if(parallel_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+
+    // chunk shader, same as in the queries example
+    std::string chunk_vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec3 normal;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   float brightness = dot(normal,normalize(vec3(1,2,3)));\n"
+        "   brightness = 0.3+((brightness>0)?0.7*brightness:0.3*brightness);\n"
+        "   fcolor = vec4(brightness,brightness,brightness,1);\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string chunk_fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = abs(fcolor);\n"
+        "}\n";
+
+    // the terrain is a grid of quads made from the vertex id that is
+    // displaced by the heightfield
+    std::string terrain_vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "uniform sampler2D heightmap;\n"
+        "out float height;\n"
+        "void main() {\n"
+        "   const int gridsize = 256;\n"
+        "   ivec2 corners[6] = ivec2[](ivec2(0,0),ivec2(0,1),ivec2(1,0),ivec2(1,0),ivec2(0,1),ivec2(1,1));\n"
+        "   int quad = gl_VertexID/6;\n"
+        "   ivec2 cell = ivec2(quad%gridsize, quad/gridsize) + corners[gl_VertexID%6];\n"
+        "   vec2 uv = vec2(cell)/gridsize;\n"
+        "   height = texture(heightmap, uv).r;\n"
+        "   gl_Position = ViewProjection*vec4(256*uv.x-128, height-80, 256*uv.y-128, 1);\n"
+        "}\n";
+
+    std::string terrain_fragment_source =
+        "#version 330\n"
+        "in float height;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(mix(vec3(0.2,0.4,0.1), vec3(0.6,0.5,0.4), 0.5+height/40),1);\n"
+        "}\n";
+
+    std::string particle_vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "void main() {\n"
+        "   gl_Position = ViewProjection*vposition;\n"
+        "}\n";
+
+    std::string particle_fragment_source =
+        "#version 330\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = vec4(1,1,1,1);\n"
+        "}\n";
+
+    const std::string program_names[] = { "chunk shader", "terrain shader", "particle shader" };
+    const std::string *program_sources[] = {
+        &chunk_vertex_source, &chunk_fragment_source,
+        &terrain_vertex_source, &terrain_fragment_source,
+        &particle_vertex_source, &particle_fragment_source,
+    };
+    enum { CHUNKS, TERRAIN, PARTICLES, PROGRAMCOUNT };
+    Program programs[PROGRAMCOUNT];
+    for(int i = 0;i<PROGRAMCOUNT;++i)
+        programs[i].started = programs[i].linked = false;
+    int next_program = 0;
+
+    SceneData scene;
+    std::vector<std::thread> workers;
+
+    if(fast) {
+        // present something right away
+        glClearColor(0.5f,0.8f,1.0f,1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glfwSwapBuffers(window);
+        phases.mark("first frame");
+
+        // the first two workers also generate the terrain and particles,
+        // all of them share the chunk meshing
+        int workercount = std::max(2u, std::min(8u, std::thread::hardware_concurrency()));
+        for(int i = 0;i<workercount;++i) {
+            workers.push_back(std::thread([&scene, &phases, i]() {
+                std::string name = "worker " + std::to_string(i);
+                if(i == 0)
+                    generate_terrain(scene, phases, name);
+                if(i == 1)
+                    generate_particles(scene, phases, name);
+                mesh_chunks(scene, phases, name);
+            }));
+        }
+    } else {
+        // the usual order, everything before the first frame
+        for(int i = 0;i<PROGRAMCOUNT;++i) {
+            ScopedPhase scope(phases, program_names[i], "main");
+            start_program(programs[i], *program_sources[2*i], *program_sources[2*i+1]);
+            if(!finish_program(programs[i])) {
+                glfwDestroyWindow(window);
+                glfwTerminate();
+                return 1;
+            }
+        }
+        next_program = PROGRAMCOUNT;
+        mesh_chunks(scene, phases, "main");
+        generate_terrain(scene, phases, "main");
+        generate_particles(scene, phases, "main");
+    }
+
+    // gpu side objects of the data sets
+    GLuint chunk_vao = 0, chunk_vbo = 0, chunk_ibo = 0;
+    GLuint terrain_vao = 0, heightmap = 0;
+    GLuint particle_vao = 0, particle_vbo = 0;
+    int chunk_indices = 0;
+    bool uploaded[PROGRAMCOUNT] = { false, false, false };
+    bool complete = false;
+    bool first_frame = !fast;
+    bool failed = false;
+
+    while(!glfwWindowShouldClose(window)) {
+        glfwPollEvents();
+
+        // get the time in seconds
+        float t = glfwGetTime();
+
+        // start compiling, without parallel compile one program per
+        // frame so the progress bar keeps moving
+        while(next_program < PROGRAMCOUNT) {
+            programs[next_program].phase = phases.begin(program_names[next_program], parallel_compile?"driver":"main");
+            start_program(programs[next_program], *program_sources[2*next_program], *program_sources[2*next_program+1]);
+            ++next_program;
+            if(!parallel_compile)
+                break;
+        }
+
+        // check programs that are done
+        for(int i = 0;i<next_program;++i) {
+            if(programs[i].linked || !program_complete(programs[i], parallel_compile))
+                continue;
+            // without parallel compile the status queries in
+            // finish_program are where the driver blocks, so they are
+            // part of the phase
+            bool linked = finish_program(programs[i]);
+            phases.end(programs[i].phase);
+            if(!linked) {
+                failed = true;
+                break;
+            }
+        }
+        if(failed)
+            break;
+
+        // upload the data sets that are ready, in fast mode one per frame
+        int uploads = fast ? 1 : PROGRAMCOUNT;
+        if(uploads > 0 && !uploaded[CHUNKS] && programs[CHUNKS].linked && scene.chunks_done == int(scene.chunks.size())) {
+            ScopedPhase scope(phases, "chunk upload", "main");
+
+            // merge the chunks into one buffer
+            std::vector<glm::vec3> vertexData;
+            for(size_t i = 0;i<scene.chunks.size();++i)
+                vertexData.insert(vertexData.end(), scene.chunks[i].begin(), scene.chunks[i].end());
+            int quadcount = vertexData.size()/8;
+
+            // generate and bind the vao
+            glGenVertexArrays(1, &chunk_vao);
+            glBindVertexArray(chunk_vao);
+
+            // generate and bind the vertex buffer object
+            glGenBuffers(1, &chunk_vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, chunk_vbo);
+
+            // upload
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*vertexData.size(), vertexData.empty()?0:&vertexData[0], GL_STATIC_DRAW);
+
+            // set up generic attrib pointers
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+            // generate and bind the index buffer object
+            glGenBuffers(1, &chunk_ibo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk_ibo);
+
+            std::vector<GLuint> indexData(6*quadcount);
+            for(int i = 0;i<quadcount;++i) {
+                indexData[6*i + 0] = 4*i + 0;
+                indexData[6*i + 1] = 4*i + 1;
+                indexData[6*i + 2] = 4*i + 2;
+                indexData[6*i + 3] = 4*i + 2;
+                indexData[6*i + 4] = 4*i + 1;
+                indexData[6*i + 5] = 4*i + 3;
+            }
+
+            // upload
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*indexData.size(), indexData.empty()?0:&indexData[0], GL_STATIC_DRAW);
+            chunk_indices = indexData.size();
+
+            uploaded[CHUNKS] = true;
+            --uploads;
+        }
+        if(uploads > 0 && !uploaded[TERRAIN] && programs[TERRAIN].linked && scene.terrain_done) {
+            ScopedPhase scope(phases, "terrain upload", "main");
+
+            // the grid is generated from the vertex id, the vao is empty
+            glGenVertexArrays(1, &terrain_vao);
+
+            glGenTextures(1, &heightmap);
+            glBindTexture(GL_TEXTURE_2D, heightmap);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, terrainsize, terrainsize, 0, GL_RED, GL_FLOAT, &scene.terrain[0]);
+
+            uploaded[TERRAIN] = true;
+            --uploads;
+        }
+        if(uploads > 0 && !uploaded[PARTICLES] && programs[PARTICLES].linked && scene.particles_done) {
+            ScopedPhase scope(phases, "particle upload", "main");
+
+            // generate and bind the vao
+            glGenVertexArrays(1, &particle_vao);
+            glBindVertexArray(particle_vao);
+
+            // generate and bind the vertex buffer object
+            glGenBuffers(1, &particle_vbo);
+            glBindBuffer(GL_ARRAY_BUFFER, particle_vbo);
+
+            // upload
+            glBufferData(GL_ARRAY_BUFFER, sizeof(glm::vec3)*scene.particles.size(), &scene.particles[0], GL_STATIC_DRAW);
+
+            // set up generic attrib pointers
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+            uploaded[PARTICLES] = true;
+        }
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, 4.0f / 3.0f, 1.0f, 500.f);
+
+        // translate the world/view position
+        glm::mat4 View = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -200.0f));
+
+        // make the camera rotate around the origin
+        View = glm::rotate(View, 20.0f, glm::vec3(1.0f, 0.0f, 0.0f));
+        View = glm::rotate(View, -10.0f*t, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        glm::mat4 ViewProjection = Projection*View;
+
+        // set clear color to sky blue
+        glClearColor(0.5f,0.8f,1.0f,1.0f);
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glEnable(GL_DEPTH_TEST);
+
+        // draw whatever is available
+        if(uploaded[CHUNKS]) {
+            glEnable(GL_CULL_FACE);
+            glUseProgram(programs[CHUNKS].program);
+            glUniformMatrix4fv(programs[CHUNKS].ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+            glBindVertexArray(chunk_vao);
+            glDrawElements(GL_TRIANGLES, chunk_indices, GL_UNSIGNED_INT, 0);
+            glDisable(GL_CULL_FACE);
+        }
+        if(uploaded[TERRAIN]) {
+            glUseProgram(programs[TERRAIN].program);
+            glUniformMatrix4fv(programs[TERRAIN].ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, heightmap);
+            glBindVertexArray(terrain_vao);
+            glDrawArrays(GL_TRIANGLES, 0, 6*256*256);
+        }
+        if(uploaded[PARTICLES]) {
+            glUseProgram(programs[PARTICLES].program);
+            glUniformMatrix4fv(programs[PARTICLES].ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+            glBindVertexArray(particle_vao);
+            glDrawArrays(GL_POINTS, 0, particles);
+        }
+
+        glDisable(GL_DEPTH_TEST);
+
+        // progress bar drawn with scissored clears so it needs no shader
+        bool done = uploaded[CHUNKS] && uploaded[TERRAIN] && uploaded[PARTICLES];
+        if(!done) {
+            int steps = scene.chunks.size() + 2 + 2*PROGRAMCOUNT;
+            int progress = scene.chunks_done + scene.terrain_done + scene.particles_done;
+            for(int i = 0;i<PROGRAMCOUNT;++i)
+                progress += programs[i].linked + uploaded[i];
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(width/4, height/2-8, width/2, 16);
+            glClearColor(0.2f,0.2f,0.2f,1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glScissor(width/4, height/2-8, (width/2*progress)/steps, 16);
+            glClearColor(1.0f,1.0f,1.0f,1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glDisable(GL_SCISSOR_TEST);
+        }
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        if(first_frame) {
+            phases.mark("first frame");
+            first_frame = false;
+        }
+        if(done && !complete) {
+            phases.mark("complete frame");
+            phases.report(fast?"startup phases (fast)":"startup phases");
+            complete = true;
+        }
+    }
+
+    // the workers have to finish before the scene goes away
+    scene.cancel = true;
+    for(size_t i = 0;i<workers.size();++i)
+        workers[i].join();
+
+    // delete the created objects
+    glDeleteVertexArrays(1, &chunk_vao);
+    glDeleteBuffers(1, &chunk_vbo);
+    glDeleteBuffers(1, &chunk_ibo);
+    glDeleteVertexArrays(1, &terrain_vao);
+    glDeleteTextures(1, &heightmap);
+    glDeleteVertexArrays(1, &particle_vao);
+    glDeleteBuffers(1, &particle_vbo);
+
+    for(int i = 0;i<PROGRAMCOUNT;++i)
+        delete_program(programs[i]);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return failed ? 1 : 0;
+}
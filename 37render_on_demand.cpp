@@ -0,0 +1,538 @@
+/* OpenGL example code - render on demand
+ *
+ * All the other examples poll for events and redraw continuously even
+ * if nothing changed. This example only draws a new frame when the
+ * current one became invalid and otherwise sleeps in glfwWaitEvents.
+ * The reasons for invalidation are tracked explicitly: the camera moved,
+ * the simulation advanced, the framebuffer was resized, the window was
+ * damaged (refresh callback) or a timed update is due. The timed update
+ * is the highlighted cube that advances once per second, the wait uses
+ * glfwWaitEventsTimeout to wake up in time for it.
+ * Every five seconds the number of drawn frames, the reasons and the
+ * cpu usage of the process are printed. A static scene only draws once
+ * per second and the process uses close to no cpu or gpu time.
+ *
+ * move with WASD keys and mouse use Q and E to "roll"
+ * toggle the simulation with P
+ * toggle between on demand and continuous rendering with space
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+
+// reasons for drawing a new frame
+enum Invalidation {
+    CAMERA = 1<<0,
+    SIMULATION = 1<<1,
+    RESIZE = 1<<2,
+    EXPOSE = 1<<3,
+    TIMER = 1<<4,
+    CONTINUOUS = 1<<5,
+    INVALIDATION_COUNT = 6
+};
+const char *invalidation_names[INVALIDATION_COUNT] = {
+    "camera", "simulation", "resize", "expose", "timer", "continuous"
+};
+
+// collects the reasons why the current frame is out of date and counts
+// them when a frame is drawn
+class FrameInvalidation {
+public:
+    FrameInvalidation() : reasons(0), frames(0)
+    {
+        reset_counts();
+    }
+
+    void invalidate(Invalidation reason) { reasons |= reason; }
+    bool pending() const { return reasons != 0; }
+
+    // called when a frame was drawn
+    void validate()
+    {
+        for(int i = 0;i<INVALIDATION_COUNT;++i)
+            if(reasons & (1<<i))
+                counts[i] += 1;
+        reasons = 0;
+        frames += 1;
+    }
+
+    void report(std::ostream &out, double seconds, double cpuseconds)
+    {
+        out << std::fixed << std::setprecision(1) << frames << " frames in " << seconds << " s, cpu "
+            << 100.0*cpuseconds/seconds << "%:";
+        for(int i = 0;i<INVALIDATION_COUNT;++i)
+            if(counts[i] > 0)
+                out << " " << invalidation_names[i] << " " << counts[i];
+        out << std::endl;
+        reset_counts();
+    }
+
+private:
+    void reset_counts()
+    {
+        frames = 0;
+        for(int i = 0;i<INVALIDATION_COUNT;++i)
+            counts[i] = 0;
+    }
+
+    unsigned reasons;
+    int frames;
+    int counts[INVALIDATION_COUNT];
+};
+
+// glfw calls this when the window contents were damaged, for example
+// after the window was uncovered
+void window_refresh(GLFWwindow *window) {
+    static_cast<FrameInvalidation*>(glfwGetWindowUserPointer(window))->invalidate(EXPOSE);
+}
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+
+int main() {
+    int width = 640;
+    int height = 480;
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // create a window
+    GLFWwindow *window;
+    if((window = glfwCreateWindow(width, height, "37render_on_demand", 0, 0)) == 0) {
+        std::cerr << "failed to open window" << std::endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // the invalidation state is reachable from the refresh callback
+    FrameInvalidation invalidation;
+    glfwSetWindowUserPointer(window, &invalidation);
+    glfwSetWindowRefreshCallback(window, window_refresh);
+
+    // shader source code
+    std::string vertex_source =
+        "#version 330\n"
+        "uniform mat4 ViewProjection;\n"
+        "uniform float time;\n"
+        "uniform int highlight;\n"
+        "layout(location = 0) in vec4 vposition;\n"
+        "layout(location = 1) in vec4 vcolor;\n"
+        "out vec4 fcolor;\n"
+        "void main() {\n"
+        "   fcolor = gl_InstanceID==highlight ? vec4(1,1,1,1) : vcolor;\n"
+        // place the instances in a 8x8x8 grid
+        "   vec3 offset = vec3(gl_InstanceID%8, (gl_InstanceID/8)%8, gl_InstanceID/64)-3.5;\n"
+        // the simulation lets the grid wave
+        "   offset.y += 0.3*sin(time+offset.x+offset.z);\n"
+        "   gl_Position = ViewProjection*vec4(0.2*vposition.xyz+offset, 1);\n"
+        "}\n";
+
+    std::string fragment_source =
+        "#version 330\n"
+        "in vec4 fcolor;\n"
+        "layout(location = 0) out vec4 FragColor;\n"
+        "void main() {\n"
+        "   FragColor = fcolor;\n"
+        "}\n";
+
+    // program and shader handles
+    GLuint shader_program, vertex_shader, fragment_shader;
+
+    // we need these to properly pass the strings
+    const char *source;
+    int length;
+
+    // create and compiler vertex shader
+    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+    source = vertex_source.c_str();
+    length = vertex_source.size();
+    glShaderSource(vertex_shader, 1, &source, &length);
+    glCompileShader(vertex_shader);
+    if(!check_shader_compile_status(vertex_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create and compiler fragment shader
+    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+    source = fragment_source.c_str();
+    length = fragment_source.size();
+    glShaderSource(fragment_shader, 1, &source, &length);
+    glCompileShader(fragment_shader);
+    if(!check_shader_compile_status(fragment_shader)) {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    // create program
+    shader_program = glCreateProgram();
+
+    // attach shaders
+    glAttachShader(shader_program, vertex_shader);
+    glAttachShader(shader_program, fragment_shader);
+
+    // link the program and check for errors
+    glLinkProgram(shader_program);
+    check_program_link_status(shader_program);
+
+    // obtain location of uniforms
+    GLint ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+    GLint time_location = glGetUniformLocation(shader_program, "time");
+    GLint highlight_location = glGetUniformLocation(shader_program, "highlight");
+
+    // vao and vbo handle
+    GLuint vao, vbo, ibo;
+
+    // generate and bind the vao
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    // generate and bind the vertex buffer object
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    // data for a cube
+    GLfloat vertexData[] = {
+    //  X     Y     Z           R     G     B
+    // face 0:
+       1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 0
+      -1.0f, 1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 1
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 0.0f, // vertex 3
+
+    // face 1:
+       1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 0.0f, // vertex 1
+       1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 2
+       1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 2:
+       1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 0
+       1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 1
+      -1.0f, 1.0f, 1.0f,       0.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f, 1.0f,-1.0f,       0.0f, 0.0f, 1.0f, // vertex 3
+
+    // face 3:
+       1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 0
+       1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 1
+      -1.0f, 1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 1.0f, 0.0f, // vertex 3
+
+    // face 4:
+      -1.0f, 1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 0
+      -1.0f, 1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 1
+      -1.0f,-1.0f, 1.0f,       0.0f, 1.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       0.0f, 1.0f, 1.0f, // vertex 3
+
+    // face 5:
+       1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 0
+      -1.0f,-1.0f, 1.0f,       1.0f, 0.0f, 1.0f, // vertex 1
+       1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 2
+      -1.0f,-1.0f,-1.0f,       1.0f, 0.0f, 1.0f, // vertex 3
+    }; // 6 faces with 4 vertices with 6 components (floats)
+
+    // fill with data
+    glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat)*6*4*6, vertexData, GL_STATIC_DRAW);
+
+    // set up generic attrib pointers
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 0*sizeof(GLfloat));
+
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6*sizeof(GLfloat), (char*)0 + 3*sizeof(GLfloat));
+
+    // generate and bind the index buffer object
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+
+    GLuint indexData[] = {
+        // face 0:
+        0,1,2,      // first triangle
+        2,1,3,      // second triangle
+        // face 1:
+        4,5,6,      // first triangle
+        6,5,7,      // second triangle
+        // face 2:
+        8,9,10,     // first triangle
+        10,9,11,    // second triangle
+        // face 3:
+        12,13,14,   // first triangle
+        14,13,15,   // second triangle
+        // face 4:
+        16,17,18,   // first triangle
+        18,17,19,   // second triangle
+        // face 5:
+        20,21,22,   // first triangle
+        22,21,23,   // second triangle
+    };
+
+    // fill with data
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint)*6*2*3, indexData, GL_STATIC_DRAW);
+
+    // we are drawing 3d objects so we want depth testing
+    glEnable(GL_DEPTH_TEST);
+
+    // camera position and orientation
+    glm::vec3 position(0.0f, 0.0f, 8.0f);
+    glm::mat4 rotation = glm::mat4(1.0f);
+
+    float t = glfwGetTime();
+
+    // the simulation time only advances while the simulation runs
+    float simulation_time = 0.0f;
+    bool simulate = false;
+    bool p_down = false;
+
+    bool continuous = false;
+    bool space_down = false;
+
+    // the highlighted cube advances every second
+    int highlight = 0;
+    double next_tick = std::floor(glfwGetTime())+1.0;
+
+    int fbwidth = 0, fbheight = 0;
+
+    // statistics
+    double report_time = glfwGetTime();
+    std::clock_t report_clock = std::clock();
+
+    // disable mouse cursor
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // mouse position
+    double mousex, mousey;
+    glfwGetCursorPos(window, &mousex, &mousey);
+
+    // the first frame always has to be drawn
+    invalidation.invalidate(EXPOSE);
+
+    // true as long as something changes every frame
+    bool animating = false;
+    while(!glfwWindowShouldClose(window)) {
+        // only sleep if nothing will change on its own
+        if(continuous || animating || invalidation.pending()) {
+            glfwPollEvents();
+        } else {
+            double timeout = next_tick-glfwGetTime();
+            if(timeout > 0.0)
+                glfwWaitEventsTimeout(timeout);
+            else
+                glfwPollEvents();
+        }
+
+        // calculate timestep, limited so the first step after
+        // sleeping doesn't jump
+        float new_t = glfwGetTime();
+        float dt = std::min(new_t - t, 1.0f/30.0f);
+        t = new_t;
+
+        // timed update
+        if(t >= next_tick) {
+            highlight = (highlight+1)%(8*8*8);
+            next_tick = std::floor(t)+1.0;
+            invalidation.invalidate(TIMER);
+        }
+
+        // update mouse differential
+        double tmpx, tmpy;
+        glfwGetCursorPos(window, &tmpx, &tmpy);
+        glm::vec2 mousediff(tmpx-mousex, tmpy-mousey);
+        mousex = tmpx;
+        mousey = tmpy;
+
+        // find up, forward and right vector
+        glm::mat3 rotation3(rotation);
+        glm::vec3 up = glm::transpose(rotation3)*glm::vec3(0.0f, 1.0f, 0.0f);
+        glm::vec3 right = glm::transpose(rotation3)*glm::vec3(1.0f, 0.0f, 0.0f);
+        glm::vec3 forward = glm::transpose(rotation3)*glm::vec3(0.0f, 0.0f,-1.0f);
+
+        // apply mouse rotation
+        rotation = glm::rotate(rotation,  0.2f*mousediff.x, up);
+        rotation = glm::rotate(rotation,  0.2f*mousediff.y, right);
+
+        // roll
+        if(glfwGetKey(window, 'Q')) {
+            rotation = glm::rotate(rotation, 180.0f*dt, forward);
+        }
+        if(glfwGetKey(window, 'E')) {
+            rotation = glm::rotate(rotation,-180.0f*dt, forward);
+        }
+
+        // movement
+        if(glfwGetKey(window, 'W')) {
+            position += 5.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'S')) {
+            position -= 5.0f*dt*forward;
+        }
+        if(glfwGetKey(window, 'D')) {
+            position += 5.0f*dt*right;
+        }
+        if(glfwGetKey(window, 'A')) {
+            position -= 5.0f*dt*right;
+        }
+
+        bool camera_moving = glfwGetKey(window, 'Q') || glfwGetKey(window, 'E') ||
+                             glfwGetKey(window, 'W') || glfwGetKey(window, 'S') ||
+                             glfwGetKey(window, 'D') || glfwGetKey(window, 'A');
+        if(camera_moving || mousediff != glm::vec2(0.0f, 0.0f))
+            invalidation.invalidate(CAMERA);
+
+        // toggle the simulation
+        if(glfwGetKey(window, 'P') && !p_down) {
+            simulate = !simulate;
+        }
+        p_down = glfwGetKey(window, 'P');
+
+        if(simulate) {
+            simulation_time += dt;
+            invalidation.invalidate(SIMULATION);
+        }
+
+        // toggle continuous rendering
+        if(glfwGetKey(window, GLFW_KEY_SPACE) && !space_down) {
+            continuous = !continuous;
+            std::cout << (continuous?"continuous":"on demand") << " rendering" << std::endl;
+        }
+        space_down = glfwGetKey(window, GLFW_KEY_SPACE);
+
+        if(continuous)
+            invalidation.invalidate(CONTINUOUS);
+
+        // resize the viewport with the framebuffer
+        int w, h;
+        glfwGetFramebufferSize(window, &w, &h);
+        if(w != fbwidth || h != fbheight) {
+            fbwidth = w;
+            fbheight = h;
+            glViewport(0, 0, fbwidth, fbheight);
+            invalidation.invalidate(RESIZE);
+        }
+
+        // keep polling while keys are held or the simulation runs
+        animating = camera_moving || simulate;
+
+        // print statistics
+        if(t-report_time >= 5.0) {
+            std::clock_t now_clock = std::clock();
+            invalidation.report(std::cout, t-report_time, double(now_clock-report_clock)/CLOCKS_PER_SEC);
+            report_time = t;
+            report_clock = now_clock;
+        }
+
+        // nothing changed, keep showing the last frame
+        if(!invalidation.pending() || fbwidth == 0 || fbheight == 0)
+            continue;
+
+        // calculate ViewProjection matrix
+        glm::mat4 Projection = glm::perspective(60.0f, float(fbwidth) / fbheight, 0.1f, 100.f);
+        glm::mat4 View = rotation*glm::translate(glm::mat4(1.0f), -position);
+        glm::mat4 ViewProjection = Projection*View;
+
+        // clear
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // use the shader program
+        glUseProgram(shader_program);
+
+        // set the uniforms
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1f(time_location, simulation_time);
+        glUniform1i(highlight_location, highlight);
+
+        // bind the vao
+        glBindVertexArray(vao);
+
+        // draw
+        glDrawElementsInstanced(GL_TRIANGLES, 6*6, GL_UNSIGNED_INT, 0, 8*8*8);
+
+        // check for errors
+        GLenum error = glGetError();
+        if(error != GL_NO_ERROR) {
+            std::cerr << error << std::endl;
+            break;
+        }
+
+        // finally swap buffers
+        glfwSwapBuffers(window);
+
+        invalidation.validate();
+    }
+
+    // delete the created objects
+
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+    glDeleteBuffers(1, &ibo);
+
+    glDetachShader(shader_program, vertex_shader);
+    glDetachShader(shader_program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+    glDeleteProgram(shader_program);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
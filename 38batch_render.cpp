@@ -0,0 +1,724 @@
+/* OpenGL example code - batch rendering
+ *
+ * renders a list of still images without any interactive window. Each
+ * job describes a camera pose around the heightfield terrain, the image
+ * size and the terrain amplitude. A pool of worker threads each owns a
+ * hidden window whose only purpose is to provide a context (windows
+ * have to be created on the main thread, the contexts can then be made
+ * current on the workers). Every worker renders its jobs into a
+ * framebuffer object and reads the pixels back asynchronously into a
+ * pixel pack buffer with a fence. The previous image is only mapped
+ * after the next one was submitted, so reading back overlaps with
+ * rendering. The pixels are handed to a writer thread that writes PNG
+ * files, the throughput in images per second is reported at the end.
+ *
+ * usage: 38batch_render [--threads N] [--out prefix] [jobfile]
+ * a job file has one job per line: name width height yaw pitch distance amplitude
+ * (angles in degrees, lines starting with # are ignored). Without a job
+ * file 64 thumbnails orbiting the terrain are rendered.
+ *
+ * Since the windows are never shown this also runs on a headless machine
+ * with a software renderer, for example mesa llvmpipe on a virtual X server:
+ *
+ *     LIBGL_ALWAYS_SOFTWARE=1 xvfb-run -a ./38batch_render
+ *
+ * Autor: Jakob Progsch
+ */
+
+#include <GLXW/glxw.h>
+#include <GLFW/glfw3.h>
+
+//glm is used to create perspective and transform matrices
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/noise.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// crc32 as used by the png chunks
+unsigned long png_crc32(const unsigned char *data, size_t size, unsigned long crc = 0) {
+    static unsigned long table[256];
+    static bool initialized = false;
+    if(!initialized) {
+        for(unsigned long n = 0;n<256;++n) {
+            unsigned long c = n;
+            for(int k = 0;k<8;++k)
+                c = (c&1) ? 0xedb88320ul^(c>>1) : c>>1;
+            table[n] = c;
+        }
+        initialized = true;
+    }
+    crc = crc^0xfffffffful;
+    for(size_t i = 0;i<size;++i)
+        crc = table[(crc^data[i])&0xff]^(crc>>8);
+    return crc^0xfffffffful;
+}
+
+void append_u32(std::vector<unsigned char> &out, unsigned long value) {
+    out.push_back((value>>24)&0xff);
+    out.push_back((value>>16)&0xff);
+    out.push_back((value>>8)&0xff);
+    out.push_back(value&0xff);
+}
+
+void write_png_chunk(std::ofstream &out, const char *type, const std::vector<unsigned char> &data) {
+    std::vector<unsigned char> chunk(type, type+4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    std::vector<unsigned char> header;
+    append_u32(header, data.size());
+    std::vector<unsigned char> footer;
+    append_u32(footer, png_crc32(&chunk[0], chunk.size()));
+    out.write(reinterpret_cast<const char*>(&header[0]), header.size());
+    out.write(reinterpret_cast<const char*>(&chunk[0]), chunk.size());
+    out.write(reinterpret_cast<const char*>(&footer[0]), footer.size());
+}
+
+// write an RGBA image as png. The image data is stored with
+// uncompressed deflate blocks so no zlib is required, the files are
+// large but writing them is fast. The rows are flipped since GL
+// images start at the bottom.
+bool write_png(const std::string &filename, const unsigned char *pixels, int width, int height) {
+    std::ofstream out(filename.c_str(), std::ios::binary);
+    if(!out)
+        return false;
+
+    const unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+
+    // 8 bit RGBA, no interlacing
+    std::vector<unsigned char> ihdr;
+    append_u32(ihdr, width);
+    append_u32(ihdr, height);
+    const unsigned char ihdr_tail[5] = {8, 6, 0, 0, 0};
+    ihdr.insert(ihdr.end(), ihdr_tail, ihdr_tail+5);
+    write_png_chunk(out, "IHDR", ihdr);
+
+    // scanlines with filter type 0 in front of each row
+    size_t rowsize = 4*width;
+    std::vector<unsigned char> raw((rowsize+1)*height);
+    for(int y = 0;y<height;++y) {
+        raw[y*(rowsize+1)] = 0;
+        std::memcpy(&raw[y*(rowsize+1)+1], pixels + (height-1-y)*rowsize, rowsize);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<unsigned char> idat;
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    unsigned long a = 1, b = 0;
+    for(size_t offset = 0;offset<raw.size();) {
+        size_t size = std::min<size_t>(65535, raw.size()-offset);
+        idat.push_back(offset+size == raw.size() ? 1 : 0);
+        idat.push_back(size&0xff);
+        idat.push_back((size>>8)&0xff);
+        idat.push_back(~size&0xff);
+        idat.push_back((~size>>8)&0xff);
+        idat.insert(idat.end(), raw.begin()+offset, raw.begin()+offset+size);
+        for(size_t i = offset;i<offset+size;++i) {
+            a = (a + raw[i])%65521;
+            b = (b + a)%65521;
+        }
+        offset += size;
+    }
+    append_u32(idat, (b<<16)|a);
+    write_png_chunk(out, "IDAT", idat);
+
+    write_png_chunk(out, "IEND", std::vector<unsigned char>());
+    return !out.fail();
+}
+
+// one image to render
+struct Job {
+    std::string name;
+    int width, height;
+    float yaw, pitch, distance, amplitude;
+};
+
+// reads jobs from a file, returns false if the file can't be opened
+bool load_jobs(const std::string &filename, std::vector<Job> &jobs) {
+    std::ifstream in(filename.c_str());
+    if(!in)
+        return false;
+    std::string line;
+    int number = 0;
+    while(std::getline(in, line)) {
+        ++number;
+        if(line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        Job job;
+        if(!(fields >> job.name >> job.width >> job.height >> job.yaw >> job.pitch >> job.distance >> job.amplitude) ||
+           job.width <= 0 || job.height <= 0) {
+            std::cerr << filename << ":" << number << ": invalid job" << std::endl;
+            continue;
+        }
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+// thumbnails orbiting the terrain
+void default_jobs(std::vector<Job> &jobs) {
+    for(int i = 0;i<64;++i) {
+        Job job;
+        std::ostringstream name;
+        name << "thumbnail_" << std::setw(3) << std::setfill('0') << i;
+        job.name = name.str();
+        job.width = 256;
+        job.height = 256;
+        job.yaw = i*360.0f/64;
+        job.pitch = 25.0f + 10.0f*(i%3);
+        job.distance = 180.0f;
+        job.amplitude = (i%2) ? 40.0f : 20.0f;
+        jobs.push_back(job);
+    }
+}
+
+// a rendered image on its way to the disk
+struct Image {
+    std::string name;
+    int width, height;
+    std::vector<unsigned char> pixels;
+};
+
+// writes images on its own thread. The queue is bounded so the render
+// workers block instead of piling up memory if the disk is too slow.
+class ImageWriter {
+public:
+    ImageWriter(const std::string &prefix, size_t maxqueued)
+        : prefix(prefix), maxqueued(maxqueued), running(true), written(0), failed(0) {
+        thread = std::thread(&ImageWriter::run, this);
+    }
+
+    ~ImageWriter() {
+        finish();
+    }
+
+    // writes the queued images and stops the thread
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            condition.notify_all();
+        }
+        if(thread.joinable())
+            thread.join();
+    }
+
+    void submit(Image &image) {
+        std::unique_lock<std::mutex> lock(mutex);
+        while(queue.size() >= maxqueued)
+            condition.wait(lock);
+        queue.push_back(Image());
+        queue.back().name = image.name;
+        queue.back().width = image.width;
+        queue.back().height = image.height;
+        queue.back().pixels.swap(image.pixels);
+        condition.notify_all();
+    }
+
+    int written_count() const { return written; }
+    int failed_count() const { return failed; }
+
+private:
+    void run() {
+        while(true) {
+            Image image;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                while(running && queue.empty())
+                    condition.wait(lock);
+                // finish the queued images before exiting
+                if(queue.empty())
+                    break;
+                image.name = queue.front().name;
+                image.width = queue.front().width;
+                image.height = queue.front().height;
+                image.pixels.swap(queue.front().pixels);
+                queue.pop_front();
+                condition.notify_all();
+            }
+
+            if(write_png(prefix + image.name + ".png", &image.pixels[0], image.width, image.height))
+                ++written;
+            else
+                ++failed;
+        }
+    }
+
+    std::string prefix;
+    size_t maxqueued;
+    std::deque<Image> queue;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool running;
+    std::atomic<int> written, failed;
+};
+
+// helper to check and display for shader compiler errors
+bool check_shader_compile_status(GLuint obj) {
+    GLint status;
+    glGetShaderiv(obj, GL_COMPILE_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetShaderiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetShaderInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+// helper to check and display for shader linker error
+bool check_program_link_status(GLuint obj) {
+    GLint status;
+    glGetProgramiv(obj, GL_LINK_STATUS, &status);
+    if(status == GL_FALSE) {
+        GLint length;
+        glGetProgramiv(obj, GL_INFO_LOG_LENGTH, &length);
+        std::vector<char> log(length);
+        glGetProgramInfoLog(obj, length, &length, &log[0]);
+        std::cerr << &log[0];
+        return false;
+    }
+    return true;
+}
+
+
+// the terrain shaders, the grid is made from the vertex id and displaced
+// by the heightfield. The normal is taken from the neighbouring texels.
+std::string vertex_source =
+    "#version 330\n"
+    "uniform mat4 ViewProjection;\n"
+    "uniform sampler2D heightmap;\n"
+    "uniform float amplitude;\n"
+    "out vec3 normal;\n"
+    "out float height;\n"
+    "void main() {\n"
+    "   const int gridsize = 256;\n"
+    "   ivec2 corners[6] = ivec2[](ivec2(0,0),ivec2(0,1),ivec2(1,0),ivec2(1,0),ivec2(0,1),ivec2(1,1));\n"
+    "   int quad = gl_VertexID/6;\n"
+    "   ivec2 cell = ivec2(quad%gridsize, quad/gridsize) + corners[gl_VertexID%6];\n"
+    "   vec2 uv = vec2(cell)/gridsize;\n"
+    "   float d = 1.0/gridsize;\n"
+    "   float dx = texture(heightmap, uv+vec2(d,0)).r - texture(heightmap, uv-vec2(d,0)).r;\n"
+    "   float dz = texture(heightmap, uv+vec2(0,d)).r - texture(heightmap, uv-vec2(0,d)).r;\n"
+    "   normal = normalize(vec3(-amplitude*dx, 2.0, -amplitude*dz));\n"
+    "   height = texture(heightmap, uv).r;\n"
+    "   gl_Position = ViewProjection*vec4(256*uv.x-128, amplitude*height, 256*uv.y-128, 1);\n"
+    "}\n";
+
+std::string fragment_source =
+    "#version 330\n"
+    "in vec3 normal;\n"
+    "in float height;\n"
+    "layout(location = 0) out vec4 FragColor;\n"
+    "void main() {\n"
+    "   float brightness = 0.3+0.7*max(0.0, dot(normalize(normal), normalize(vec3(1,2,3))));\n"
+    "   vec3 color = mix(vec3(0.2,0.4,0.1), vec3(0.6,0.5,0.4), clamp(0.5+height, 0.0, 1.0));\n"
+    "   FragColor = vec4(brightness*color, 1);\n"
+    "}\n";
+
+// a render thread with its own context that takes jobs from the shared
+// list until there are none left
+class RenderWorker {
+public:
+    RenderWorker(GLFWwindow *window, int index, const std::vector<Job> &jobs, std::atomic<size_t> &next_job,
+                 const std::vector<GLfloat> &heightData, int heightsize, ImageWriter &writer)
+        : window(window), index(index), jobs(jobs), next_job(next_job), heightData(heightData),
+          heightsize(heightsize), writer(writer), rendered(0), job_failures(0), readback_wait(0.0), failed(false) {
+        thread = std::thread(&RenderWorker::run, this);
+    }
+
+    void join() { thread.join(); }
+
+    int rendered_count() const { return rendered; }
+    int failed_count() const { return job_failures; }
+    double readback_wait_time() const { return readback_wait; }
+    bool setup_failed() const { return failed; }
+
+private:
+    // the readback of one image, two of them are in flight
+    struct Readback {
+        GLuint pbo;
+        GLsync fence;
+        size_t capacity;
+        bool failed;
+        Image image;
+    };
+
+    void run() {
+        glfwMakeContextCurrent(window);
+        if(setup()) {
+            for(size_t job = next_job++;job<jobs.size();job = next_job++)
+                render(jobs[job]);
+            // collect the images still in flight
+            for(int i = 0;i<2;++i)
+                finish(readbacks[(current+i)%2]);
+        }
+        cleanup();
+        glfwMakeContextCurrent(0);
+    }
+
+    bool setup() {
+        // program and shader handles
+        GLuint vertex_shader, fragment_shader;
+
+        // we need these to properly pass the strings
+        const char *source;
+        int length;
+
+        // create and compiler vertex shader
+        vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+        source = vertex_source.c_str();
+        length = vertex_source.size();
+        glShaderSource(vertex_shader, 1, &source, &length);
+        glCompileShader(vertex_shader);
+
+        // create and compiler fragment shader
+        fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+        source = fragment_source.c_str();
+        length = fragment_source.size();
+        glShaderSource(fragment_shader, 1, &source, &length);
+        glCompileShader(fragment_shader);
+
+        // create program
+        shader_program = glCreateProgram();
+
+        // attach shaders
+        glAttachShader(shader_program, vertex_shader);
+        glAttachShader(shader_program, fragment_shader);
+
+        // link the program and check for errors, the shaders are
+        // flagged for deletion and go away with the program
+        glLinkProgram(shader_program);
+        bool ok = check_shader_compile_status(vertex_shader) &&
+                  check_shader_compile_status(fragment_shader) &&
+                  check_program_link_status(shader_program);
+        glDeleteShader(vertex_shader);
+        glDeleteShader(fragment_shader);
+
+        // obtain location of uniforms
+        ViewProjection_location = glGetUniformLocation(shader_program, "ViewProjection");
+        amplitude_location = glGetUniformLocation(shader_program, "amplitude");
+
+        // the grid is generated from the vertex id, the vao is empty
+        glGenVertexArrays(1, &vao);
+
+        // each context gets its own copy of the heightfield
+        glGenTextures(1, &heightmap);
+        glBindTexture(GL_TEXTURE_2D, heightmap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, heightsize, heightsize, 0, GL_RED, GL_FLOAT, &heightData[0]);
+
+        // the framebuffer attachments are allocated per job size
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &color_rbf);
+        glGenRenderbuffers(1, &depth_rbf);
+        fbwidth = fbheight = 0;
+
+        for(int i = 0;i<2;++i) {
+            glGenBuffers(1, &readbacks[i].pbo);
+            readbacks[i].fence = 0;
+            readbacks[i].capacity = 0;
+            readbacks[i].failed = false;
+        }
+        current = 0;
+
+        failed = !ok;
+        return ok;
+    }
+
+    void render(const Job &job) {
+        // (re)allocate the render targets if the size changed
+        if(job.width != fbwidth || job.height != fbheight) {
+            fbwidth = job.width;
+            fbheight = job.height;
+            glBindRenderbuffer(GL_RENDERBUFFER, color_rbf);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, fbwidth, fbheight);
+            glBindRenderbuffer(GL_RENDERBUFFER, depth_rbf);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, fbwidth, fbheight);
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_rbf);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_rbf);
+            if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+                std::cerr << "worker " << index << ": " << job.name << ": incomplete framebuffer" << std::endl;
+                // force a reallocation for the next job
+                fbwidth = fbheight = 0;
+                ++job_failures;
+                return;
+            }
+        }
+
+        // camera orbiting the center of the terrain
+        float yaw = glm::radians(job.yaw), pitch = glm::radians(job.pitch);
+        glm::vec3 eye = job.distance*glm::vec3(std::cos(pitch)*std::sin(yaw), std::sin(pitch), std::cos(pitch)*std::cos(yaw));
+        glm::mat4 Projection = glm::perspective(60.0f, float(job.width) / job.height, 1.0f, 1000.f);
+        glm::mat4 View = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 ViewProjection = Projection*View;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, job.width, job.height);
+
+        // set clear color to sky blue
+        glClearColor(0.5f,0.8f,1.0f,1.0f);
+        glEnable(GL_DEPTH_TEST);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        glUseProgram(shader_program);
+        glUniformMatrix4fv(ViewProjection_location, 1, GL_FALSE, glm::value_ptr(ViewProjection));
+        glUniform1f(amplitude_location, job.amplitude);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, heightmap);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, 6*256*256);
+
+        // start the readback, this returns immediately
+        Readback &readback = readbacks[current];
+        size_t size = size_t(4)*job.width*job.height;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        if(size > readback.capacity) {
+            glBufferData(GL_PIXEL_PACK_BUFFER, size, 0, GL_STREAM_READ);
+            readback.capacity = size;
+        }
+        glReadBuffer(GL_COLOR_ATTACHMENT0);
+        glReadPixels(0, 0, job.width, job.height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readback.image.name = job.name;
+        readback.image.width = job.width;
+        readback.image.height = job.height;
+
+        // check for errors, a failed image is still collected to keep
+        // the ring in order but not written
+        GLenum error = glGetError();
+        readback.failed = error != GL_NO_ERROR;
+        if(readback.failed)
+            std::cerr << "worker " << index << ": " << job.name << ": " << error << std::endl;
+
+        // while the gpu works on this image collect the previous one
+        current = (current+1)%2;
+        finish(readbacks[current]);
+    }
+
+    // waits for a readback and hands the image to the writer
+    void finish(Readback &readback) {
+        if(readback.fence == 0)
+            return;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while(glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000) == GL_TIMEOUT_EXPIRED) { }
+        readback_wait += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        glDeleteSync(readback.fence);
+        readback.fence = 0;
+        if(readback.failed) {
+            ++job_failures;
+            return;
+        }
+
+        Image &image = readback.image;
+        size_t size = size_t(4)*image.width*image.height;
+        image.pixels.resize(size);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pbo);
+        void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+        if(mapped) {
+            std::memcpy(&image.pixels[0], mapped, size);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            writer.submit(image);
+            ++rendered;
+        } else {
+            ++job_failures;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    void cleanup() {
+        for(int i = 0;i<2;++i) {
+            if(readbacks[i].fence)
+                glDeleteSync(readbacks[i].fence);
+            glDeleteBuffers(1, &readbacks[i].pbo);
+        }
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &color_rbf);
+        glDeleteRenderbuffers(1, &depth_rbf);
+        glDeleteTextures(1, &heightmap);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(shader_program);
+    }
+
+    GLFWwindow *window;
+    int index;
+    const std::vector<Job> &jobs;
+    std::atomic<size_t> &next_job;
+    const std::vector<GLfloat> &heightData;
+    int heightsize;
+    ImageWriter &writer;
+
+    GLuint shader_program, vao, heightmap, fbo, color_rbf, depth_rbf;
+    GLint ViewProjection_location, amplitude_location;
+    int fbwidth, fbheight;
+    Readback readbacks[2];
+    int current;
+
+    std::atomic<int> rendered, job_failures;
+    double readback_wait;
+    bool failed;
+    std::thread thread;
+};
+
+int main(int argc, char *argv[]) {
+    int threadcount = std::max(1u, std::min(4u, std::thread::hardware_concurrency()));
+    std::string prefix = "";
+    std::string jobfile;
+    for(int i = 1;i<argc;++i) {
+        std::string arg = argv[i];
+        if(arg == "--threads" && i+1<argc)
+            threadcount = std::max(1, std::atoi(argv[++i]));
+        else if(arg == "--out" && i+1<argc)
+            prefix = argv[++i];
+        else
+            jobfile = arg;
+    }
+
+    std::vector<Job> jobs;
+    if(jobfile.empty()) {
+        default_jobs(jobs);
+    } else if(!load_jobs(jobfile, jobs)) {
+        std::cerr << "failed to open " << jobfile << std::endl;
+        return 1;
+    }
+    threadcount = std::min<int>(threadcount, std::max<size_t>(1, jobs.size()));
+
+    if(glfwInit() == GL_FALSE) {
+        std::cerr << "failed to init GLFW" << std::endl;
+        return 1;
+    }
+
+    // select opengl version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+    // the windows only provide the contexts and are never shown
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+
+    // create the windows, this has to happen on the main thread
+    std::vector<GLFWwindow*> windows;
+    for(int i = 0;i<threadcount;++i) {
+        GLFWwindow *window = glfwCreateWindow(1, 1, "38batch_render", 0, 0);
+        if(window == 0) {
+            std::cerr << "failed to open window" << std::endl;
+            for(size_t j = 0;j<windows.size();++j)
+                glfwDestroyWindow(windows[j]);
+            glfwTerminate();
+            return 1;
+        }
+        windows.push_back(window);
+    }
+
+    // the function pointers are loaded once, all contexts come from the
+    // same driver and pixel format
+    glfwMakeContextCurrent(windows[0]);
+
+    if(glxwInit()) {
+        std::cerr << "failed to init GL3W" << std::endl;
+        for(size_t i = 0;i<windows.size();++i)
+            glfwDestroyWindow(windows[i]);
+        glfwTerminate();
+        return 1;
+    }
+
+    // drop the jobs the render targets can't hold, the limits are only
+    // known once a context exists
+    GLint maxrenderbuffer, maxviewport[2];
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxrenderbuffer);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxviewport);
+    int rejected = 0;
+    for(size_t i = 0;i<jobs.size();) {
+        if(jobs[i].width > std::min(maxrenderbuffer, maxviewport[0]) ||
+           jobs[i].height > std::min(maxrenderbuffer, maxviewport[1])) {
+            std::cerr << jobs[i].name << ": " << jobs[i].width << "x" << jobs[i].height
+                      << " exceeds the maximum render target size" << std::endl;
+            jobs.erase(jobs.begin()+i);
+            ++rejected;
+        } else {
+            ++i;
+        }
+    }
+
+    std::cout << "rendering " << jobs.size() << " images with " << threadcount << " contexts on "
+              << glGetString(GL_RENDERER) << std::endl;
+
+    // the workers make their contexts current on their own threads
+    glfwMakeContextCurrent(0);
+
+    // the heightfield is generated once and shared by all workers
+    const int heightsize = 1024;
+    std::vector<GLfloat> heightData(heightsize*heightsize);
+    for(int y = 0;y<heightsize;++y)
+        for(int x = 0;x<heightsize;++x)
+            heightData[y*heightsize+x] = glm::perlin(0.01f*glm::vec2(x, y));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    int written, failed;
+    int render_failed = rejected;
+    std::vector<int> rendered(threadcount);
+    std::vector<double> waited(threadcount);
+    bool setup_failed = false;
+    {
+        ImageWriter writer(prefix, 4*threadcount);
+        std::atomic<size_t> next_job(0);
+        std::vector<RenderWorker*> workers;
+        for(int i = 0;i<threadcount;++i)
+            workers.push_back(new RenderWorker(windows[i], i, jobs, next_job, heightData, heightsize, writer));
+        for(int i = 0;i<threadcount;++i) {
+            workers[i]->join();
+            rendered[i] = workers[i]->rendered_count();
+            render_failed += workers[i]->failed_count();
+            waited[i] = workers[i]->readback_wait_time();
+            setup_failed = setup_failed || workers[i]->setup_failed();
+            delete workers[i];
+        }
+        writer.finish();
+        written = writer.written_count();
+        failed = writer.failed_count();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+    for(int i = 0;i<threadcount;++i)
+        std::cout << "worker " << i << ": " << rendered[i] << " images, "
+                  << std::fixed << std::setprecision(1) << 1000.0*waited[i] << " ms waiting for readbacks" << std::endl;
+    std::cout << written << " images written";
+    if(failed > 0)
+        std::cout << ", " << failed << " failed to write";
+    if(render_failed > 0)
+        std::cout << ", " << render_failed << " failed to render";
+    std::cout << " in " << std::setprecision(2) << seconds << " s, "
+              << std::setprecision(1) << (written+failed)/seconds << " images/s" << std::endl;
+
+    for(size_t i = 0;i<windows.size();++i)
+        glfwDestroyWindow(windows[i]);
+    glfwTerminate();
+    return (setup_failed || failed > 0 || render_failed > 0) ? 1 : 0;
+}